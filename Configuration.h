@@ -6,6 +6,7 @@
 #include <sstream>
 #include <string>
 #include <map>
+#include <vector>
 #include "/usr/include/jsoncpp/json/json.h"
 #include <stdexcept>
 #include <algorithm>
@@ -15,13 +16,38 @@
 //g++ -o main main.cpp -ljsoncpp
 
 struct IMUConfig {
+    struct Model {
+        std::string name;
+        std::string path;
+        std::string optimized_path;    // empty: optimize on every start
+    };
     std::string imu_model_path;
     std::string i2c_device;
     int i2c_addr;
     int WHO_AM_I;
     int CTRL1;
+    int CTRL2;
     int ON_CTRL1;
     int OUT_X_L, OUT_X_H, OUT_Y_L, OUT_Y_H, OUT_Z_L, OUT_Z_H;
+    int FIFO_CTRL = 46, FIFO_SAMPLES = 47;
+    int odr_hz = 200;
+    int sample_hz = 50;
+    int fifo_drain_ms = 100;
+    int window_hop = 30;
+    int ort_threads = 1;
+    bool ort_arena = true;
+    std::string ort_optimization = "all";
+    std::string ort_optimized_model_path;
+    std::vector<Model> models;    // first is primary; empty: imu_model_path alone
+    int max_batch = 8;
+    double fall_counts_per_g = 16384;
+    double fall_freefall_g = 0.5;
+    int fall_freefall_ms = 60;
+    double fall_impact_g = 1.8;
+    int fall_impact_window_ms = 1000;
+    int fall_confirm_windows = 3;
+    std::string record_file;
+    std::string i2c_replay_file;
 };
 
 class Configuration {
@@ -79,6 +105,14 @@ class Configuration {
         int rotate;    
         int font_size;    
         std::string todo;
+        std::string cache_folder;
+        int render_cache_mb;
+        int page_cache_mb;
+        std::string log_level;
+        std::map<std::string, int> log_levels;
+        std::string log_format;
+        std::string log_event_file;
+        int log_event_mb;
         // std::string vosk_model;
         std::string default_language;
         int debug;
@@ -203,6 +237,20 @@ class Configuration {
                 font_size = config["font_size"].asInt();
                 camera_device = config["camera_device"].asString();                
                 todo = config["todo"].asString();
+                cache_folder = config.isMember("cache_folder") ? config["cache_folder"].asString() : path_to_save_file + "/cache/";
+                render_cache_mb = config.isMember("render_cache_mb") ? config["render_cache_mb"].asInt() : 64;
+                page_cache_mb = config.isMember("page_cache_mb") ? config["page_cache_mb"].asInt() : 256;
+                log_level = config.isMember("log_level") ? config["log_level"].asString() : "INFO";
+                if (config.isMember("log_levels") && config["log_levels"].isObject()) {
+                    for (const auto& module : config["log_levels"].getMemberNames())
+                        log_levels[module] = Logger::parseLevel(config["log_levels"][module].asString());
+                }
+                Logger::setLevels(Logger::parseLevel(log_level), log_levels);
+                log_format = config.isMember("log_format") ? config["log_format"].asString() : "text";
+                log_event_file = config.isMember("log_event_file") ? config["log_event_file"].asString() : path_to_save_file + "/events.bin";
+                log_event_mb = config.isMember("log_event_mb") ? config["log_event_mb"].asInt() : 8;
+                if (log_format == "binary" && !Logger::useEventLog(log_event_file, static_cast<uint64_t>(log_event_mb) * 1024 * 1024, 4))
+                    LOG_ERROR("Can't open event log " + log_event_file + ", logging as text");
                 // vosk_model = config["vosk_model"].asString();
                 default_language = config["default_language"].asString();
                 debug = config["debug"].asInt();
@@ -324,6 +372,7 @@ class Configuration {
                     imu.i2c_addr = imu_j["i2c_addr"].asInt();
                     imu.WHO_AM_I = imu_j["WHO_AM_I"].asInt();
                     imu.CTRL1 = imu_j["CTRL1"].asInt();
+                    imu.CTRL2 = imu_j.isMember("CTRL2") ? imu_j["CTRL2"].asInt() : 33;
                     imu.ON_CTRL1 = imu_j["ON_CTRL1"].asInt();
                     imu.OUT_X_L = imu_j["OUT_X_L"].asInt();
                     imu.OUT_X_H = imu_j["OUT_X_H"].asInt();
@@ -331,6 +380,29 @@ class Configuration {
                     imu.OUT_Y_H = imu_j["OUT_Y_H"].asInt();
                     imu.OUT_Z_L = imu_j["OUT_Z_L"].asInt();
                     imu.OUT_Z_H = imu_j["OUT_Z_H"].asInt();
+                    imu.FIFO_CTRL = imu_j.isMember("FIFO_CTRL") ? imu_j["FIFO_CTRL"].asInt() : 46;
+                    imu.FIFO_SAMPLES = imu_j.isMember("FIFO_SAMPLES") ? imu_j["FIFO_SAMPLES"].asInt() : 47;
+                    imu.odr_hz = imu_j.isMember("odr_hz") ? imu_j["odr_hz"].asInt() : 200;
+                    imu.sample_hz = imu_j.isMember("sample_hz") ? imu_j["sample_hz"].asInt() : 50;
+                    imu.fifo_drain_ms = imu_j.isMember("fifo_drain_ms") ? imu_j["fifo_drain_ms"].asInt() : 100;
+                    imu.window_hop = imu_j.isMember("window_hop") ? imu_j["window_hop"].asInt() : 30;
+                    imu.ort_threads = imu_j.isMember("ort_threads") ? imu_j["ort_threads"].asInt() : 1;
+                    imu.ort_arena = imu_j.isMember("ort_arena") ? imu_j["ort_arena"].asBool() : true;
+                    imu.ort_optimization = imu_j.isMember("ort_optimization") ? imu_j["ort_optimization"].asString() : "all";
+                    imu.ort_optimized_model_path = imu_j.isMember("ort_optimized_model_path") ? imu_j["ort_optimized_model_path"].asString() : "";
+                    imu.fall_counts_per_g = imu_j.isMember("fall_counts_per_g") ? imu_j["fall_counts_per_g"].asDouble() : 16384;
+                    imu.fall_freefall_g = imu_j.isMember("fall_freefall_g") ? imu_j["fall_freefall_g"].asDouble() : 0.5;
+                    imu.fall_freefall_ms = imu_j.isMember("fall_freefall_ms") ? imu_j["fall_freefall_ms"].asInt() : 60;
+                    imu.fall_impact_g = imu_j.isMember("fall_impact_g") ? imu_j["fall_impact_g"].asDouble() : 1.8;
+                    imu.fall_impact_window_ms = imu_j.isMember("fall_impact_window_ms") ? imu_j["fall_impact_window_ms"].asInt() : 1000;
+                    imu.fall_confirm_windows = imu_j.isMember("fall_confirm_windows") ? imu_j["fall_confirm_windows"].asInt() : 3;
+                    imu.record_file = imu_j.isMember("record_file") ? imu_j["record_file"].asString() : "";
+                    imu.i2c_replay_file = imu_j.isMember("i2c_replay_file") ? imu_j["i2c_replay_file"].asString() : "";
+                    imu.max_batch = imu_j.isMember("max_batch") ? imu_j["max_batch"].asInt() : 8;
+                    if (imu_j.isMember("models") && imu_j["models"].isArray()) {
+                        for (const auto& model : imu_j["models"])
+                            imu.models.push_back({model["name"].asString(), model["path"].asString(), model.isMember("optimized_path") ? model["optimized_path"].asString() : ""});
+                    }
                 }
                 LOG_INFO("Finish Reading Config File");
             } catch (const std::exception &e) {
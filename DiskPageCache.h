@@ -0,0 +1,375 @@
+#ifndef DISKPAGECACHE_H
+#define DISKPAGECACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <openssl/evp.h>
+#include <QImage>
+#include <QString>
+#include <poppler-qt5.h>
+#include "Logger.h"
+
+// Rendered PDF pages kept on disk across sessions as PNG files named <content hash>_p<page>_z<zoom>.png.
+// Keys use the SHA-256 of the file content, so a document replaced by a download never matches its old pages.
+// Total size is capped by a quota; the least recently used pages are evicted first.
+class DiskPageCache {
+public:
+    DiskPageCache(const std::string& _folder, size_t _quota_bytes)
+        : folder(_folder), quota_bytes(_quota_bytes), warming(false), stop_requested(false), rewarm_pending(false) {
+        LOG_INFO("DiskPageCache Constructor");
+        scan();
+    }
+
+    ~DiskPageCache() {
+        stop_requested = true;
+        if (warmer.joinable()) {
+            warmer.join();
+        }
+    }
+
+    DiskPageCache(const DiskPageCache&) = delete;
+    DiskPageCache& operator=(const DiskPageCache&) = delete;
+
+    // Hex SHA-256 prefix of the file content, memoized by path, size and mtime. Empty on error.
+    // Reads the whole file on a miss, so not for the UI thread; see knownHash().
+    std::string contentHash(const std::string& path) {
+        try {
+            uint64_t size;
+            int64_t mtime;
+            if (!statFile(path, size, mtime))
+                return "";
+            {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                auto it = hashes.find(path);
+                if (it != hashes.end() && it->second.size == size && it->second.mtime == mtime)
+                    return it->second.hash;
+            }
+            std::string hash = sha256(path);
+            if (hash.empty())
+                return hash;
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            hashes[path] = {size, mtime, hash};
+            return hash;
+        } catch (const std::exception& e) {
+            LOG_ERROR("DiskPageCache contentHash error: " + std::string(e.what()));
+            return "";
+        }
+    }
+
+    // Memoized hash only, empty if the file was not hashed since it last changed. Never reads the file.
+    std::string knownHash(const std::string& path) {
+        uint64_t size;
+        int64_t mtime;
+        if (!statFile(path, size, mtime))
+            return "";
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = hashes.find(path);
+        if (it != hashes.end() && it->second.size == size && it->second.mtime == mtime)
+            return it->second.hash;
+        return "";
+    }
+
+    bool contains(const std::string& hash, int page, float zoom) {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        return entries.count(fileName(hash, page, zoom)) > 0;
+    }
+
+    bool load(const std::string& hash, int page, float zoom, QImage& out) {
+        try {
+            std::string name = fileName(hash, page, zoom);
+            {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                auto it = entries.find(name);
+                if (it == entries.end())
+                    return false;
+                it->second.last_access = now();
+            }
+            std::string path = folder + name;
+            if (!out.load(QString::fromStdString(path), "PNG")) {
+                LOG_WARN("DiskPageCache dropping unreadable " + name);
+                remove(name);
+                return false;
+            }
+            // Persist the access time for LRU across sessions
+            std::error_code ec;
+            std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+            return true;
+        } catch (const std::exception& e) {
+            LOG_ERROR("DiskPageCache load error: " + std::string(e.what()));
+            return false;
+        }
+    }
+
+    bool store(const std::string& hash, int page, float zoom, const QImage& image) {
+        try {
+            if (hash.empty() || image.isNull())
+                return false;
+            std::string name = fileName(hash, page, zoom);
+            std::string path = folder + name;
+            // Per-thread temp name: the warmer and a render worker may store the same page at once
+            std::string tmp = path + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+            std::error_code ec;
+            std::filesystem::create_directories(folder, ec);
+            if (!image.save(QString::fromStdString(tmp), "PNG")) {
+                LOG_WARN("DiskPageCache can't write " + tmp);
+                std::remove(tmp.c_str());
+                return false;
+            }
+            std::filesystem::rename(tmp, path, ec);
+            if (ec) {
+                std::remove(tmp.c_str());
+                return false;
+            }
+            uint64_t bytes = static_cast<uint64_t>(std::filesystem::file_size(path, ec));
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            auto it = entries.find(name);
+            if (it != entries.end())
+                total_bytes -= it->second.bytes;
+            entries[name] = {bytes, now()};
+            total_bytes += bytes;
+            evict();
+            return true;
+        } catch (const std::exception& e) {
+            LOG_ERROR("DiskPageCache store error: " + std::string(e.what()));
+            return false;
+        }
+    }
+
+    // Drop pages of every document whose hash is not in live_hashes
+    void prune(const std::set<std::string>& live_hashes) {
+        std::vector<std::string> stale;
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            for (const auto& kv : entries) {
+                if (!live_hashes.count(kv.first.substr(0, kv.first.find('_'))))
+                    stale.push_back(kv.first);
+            }
+        }
+        for (const auto& name : stale)
+            remove(name);
+        if (!stale.empty())
+            LOG_INFO("DiskPageCache pruned " + std::to_string(stale.size()) + " pages of replaced documents");
+    }
+
+    // On a background thread: hash every PDF of pdf_folder, prune pages of documents that are gone and
+    // render the first page of each at zoom if it is not cached yet
+    void warm(const std::string& pdf_folder, float zoom) {
+        try {
+            std::lock_guard<std::mutex> state_lock(state_mutex);
+            warm_folder = pdf_folder;
+            warm_zoom = zoom;
+            if (warming) {
+                rewarm_pending = true;
+                return;
+            }
+            if (warmer.joinable()) {
+                warmer.join();
+            }
+            warming = true;
+            warmer = std::thread([this]() { WarmLoop(); });
+        } catch (const std::exception& e) {
+            warming = false;
+            LOG_ERROR("DiskPageCache warm error: " + std::string(e.what()));
+        }
+    }
+
+private:
+    struct Entry {
+        uint64_t bytes;
+        int64_t last_access;
+    };
+
+    struct Hash {
+        uint64_t size;
+        int64_t mtime;
+        std::string hash;
+    };
+
+    std::string folder;
+    size_t quota_bytes;
+    uint64_t total_bytes = 0;
+    std::map<std::string, Entry> entries;
+    std::map<std::string, Hash> hashes;
+    std::mutex cache_mutex;
+    std::mutex state_mutex;                // warming / rewarm_pending handshake
+    std::string warm_folder;
+    float warm_zoom = 1.5f;
+    std::thread warmer;
+    std::atomic<bool> warming;
+    std::atomic<bool> stop_requested;
+    std::atomic<bool> rewarm_pending;
+
+    static int64_t now() {
+        return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    static bool statFile(const std::string& path, uint64_t& size, int64_t& mtime) {
+        std::error_code ec;
+        size = static_cast<uint64_t>(std::filesystem::file_size(path, ec));
+        if (ec)
+            return false;
+        mtime = static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+        return !ec;
+    }
+
+    static std::string fileName(const std::string& hash, int page, float zoom) {
+        return hash + "_p" + std::to_string(page) + "_z" + std::to_string(static_cast<int>(zoom * 1000.0f + 0.5f)) + ".png";
+    }
+
+    static std::string sha256(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open())
+            return "";
+        std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+        if (!ctx || EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr) != 1)
+            return "";
+        std::vector<char> buffer(1 << 20);
+        while (in) {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            if (in.gcount() > 0)
+                EVP_DigestUpdate(ctx.get(), buffer.data(), static_cast<size_t>(in.gcount()));
+        }
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int length = 0;
+        if (EVP_DigestFinal_ex(ctx.get(), digest, &length) != 1)
+            return "";
+        static const char hex[] = "0123456789abcdef";
+        std::string result;
+        // 128 bits are plenty to tell a handful of manuals apart and keep file names short
+        for (unsigned int i = 0; i < std::min(length, 16u); ++i) {
+            result += hex[digest[i] >> 4];
+            result += hex[digest[i] & 0x0F];
+        }
+        return result;
+    }
+
+    void scan() {
+        try {
+            std::error_code ec;
+            std::filesystem::create_directories(folder, ec);
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            for (const auto& file : std::filesystem::directory_iterator(folder, ec)) {
+                if (!file.is_regular_file())
+                    continue;
+                std::string name = file.path().filename().string();
+                if (file.path().extension() != ".png") {
+                    // Leftover of an interrupted store
+                    if (file.path().extension() == ".tmp")
+                        std::filesystem::remove(file.path(), ec);
+                    continue;
+                }
+                uint64_t bytes = static_cast<uint64_t>(file.file_size());
+                auto mtime = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+                    file.last_write_time() - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
+                entries[name] = {bytes, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::seconds>(mtime.time_since_epoch()).count())};
+                total_bytes += bytes;
+            }
+            evict();
+            LOG_INFO("DiskPageCache " + std::to_string(entries.size()) + " pages, " + std::to_string(total_bytes / 1024) + " KB");
+        } catch (const std::exception& e) {
+            LOG_ERROR("DiskPageCache scan error: " + std::string(e.what()));
+        }
+    }
+
+    // Caller holds cache_mutex
+    void evict() {
+        while (total_bytes > quota_bytes && !entries.empty()) {
+            auto oldest = entries.begin();
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (it->second.last_access < oldest->second.last_access)
+                    oldest = it;
+            }
+            std::error_code ec;
+            std::filesystem::remove(folder + oldest->first, ec);
+            total_bytes -= oldest->second.bytes;
+            entries.erase(oldest);
+        }
+    }
+
+    void remove(const std::string& name) {
+        std::error_code ec;
+        std::filesystem::remove(folder + name, ec);
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = entries.find(name);
+        if (it != entries.end()) {
+            total_bytes -= it->second.bytes;
+            entries.erase(it);
+        }
+    }
+
+    void WarmLoop() {
+        while (!stop_requested) {
+            std::string pdf_folder;
+            float zoom;
+            {
+                std::lock_guard<std::mutex> state_lock(state_mutex);
+                rewarm_pending = false;
+                pdf_folder = warm_folder;
+                zoom = warm_zoom;
+            }
+            WarmOnce(pdf_folder, zoom);
+            std::lock_guard<std::mutex> state_lock(state_mutex);
+            if (!rewarm_pending || stop_requested) {
+                warming = false;
+                return;
+            }
+        }
+        warming = false;
+    }
+
+    void WarmOnce(const std::string& pdf_folder, float zoom) {
+        try {
+            auto start = std::chrono::steady_clock::now();
+            std::set<std::string> live;
+            int rendered = 0;
+            std::error_code ec;
+            for (const auto& file : std::filesystem::directory_iterator(pdf_folder, ec)) {
+                if (stop_requested)
+                    return;
+                if (!file.is_regular_file() || file.path().extension() != ".pdf")
+                    continue;
+                std::string path = file.path().string();
+                std::string hash = contentHash(path);
+                if (hash.empty())
+                    continue;
+                live.insert(hash);
+                if (contains(hash, 0, zoom))
+                    continue;
+                std::unique_ptr<Poppler::Document> doc(Poppler::Document::load(QString::fromStdString(path)));
+                if (!doc || doc->isLocked() || doc->numPages() < 1)
+                    continue;
+                doc->setRenderHint(Poppler::Document::Antialiasing);
+                doc->setRenderHint(Poppler::Document::TextAntialiasing);
+                std::unique_ptr<Poppler::Page> page(doc->page(0));
+                if (!page)
+                    continue;
+                if (store(hash, 0, zoom, page->renderToImage(zoom * 72.0, zoom * 72.0)))
+                    ++rendered;
+            }
+            if (ec) {
+                LOG_WARN("DiskPageCache can't list " + pdf_folder);
+                return;
+            }
+            prune(live);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            LOG_INFO("DiskPageCache warmed " + std::to_string(rendered) + " of " + std::to_string(live.size()) +
+                     " documents in " + std::to_string(ms) + " ms");
+        } catch (const std::exception& e) {
+            LOG_ERROR("DiskPageCache WarmOnce error: " + std::string(e.what()));
+        }
+    }
+};
+
+#endif // DISKPAGECACHE_H
@@ -0,0 +1,345 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <sstream>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Compact binary event log written by Logger when "log_format" is "binary", and read back by event_log_decoder.
+//
+// File:   "HEL1" magic, varint start time (us since epoch), then records.
+// SITE  = 0x01, varint id, u8 level, string file, string function, varint line, string pattern
+// EVENT = 0x02, varint site id, zigzag varint us since the previous event, varint thread index, fields..., 0x00
+// Field = u8 type then 'i' zigzag varint | 'u' varint | 'd' 8 byte double | 's' string | 'b' u8
+// Strings are a varint length followed by the bytes. A call site is defined once per file, so every file after a
+// size-based rotation (path, path.1, path.2, ...) decodes on its own.
+
+namespace eventlog {
+
+static constexpr char MAGIC[4] = {'H', 'E', 'L', '1'};
+enum RecordType : uint8_t { SITE = 0x01, EVENT = 0x02 };
+enum FieldType : uint8_t { END = 0x00, INT = 'i', UINT = 'u', DOUBLE = 'd', STRING = 's', BOOL = 'b' };
+
+inline void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+inline void putZigzag(std::string& out, int64_t value) {
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+inline void putString(std::string& out, const char* data, size_t size) {
+    putVarint(out, size);
+    out.append(data, size);
+}
+
+inline bool getVarint(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+inline bool getZigzag(const char*& p, const char* end, int64_t& value) {
+    uint64_t raw;
+    if (!getVarint(p, end, raw))
+        return false;
+    value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+}
+
+inline bool getString(const char*& p, const char* end, std::string& value) {
+    uint64_t size;
+    if (!getVarint(p, end, size) || size > static_cast<uint64_t>(end - p))
+        return false;
+    value.assign(p, static_cast<size_t>(size));
+    p += size;
+    return true;
+}
+
+// Encodes events into a batch and appends it to the current file, rotating by size. Not thread safe; Logger only
+// uses it from its writer thread.
+class Writer {
+public:
+    ~Writer() {
+        close();
+    }
+
+    bool open(const std::string& _path, uint64_t _max_bytes, int _keep_files) {
+        close();
+        path = _path;
+        max_bytes = _max_bytes;
+        keep_files = _keep_files;
+        // The previous run's events become path.1
+        shiftFiles();
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return false;
+        startFile();
+        return true;
+    }
+
+    bool isOpen() const {
+        return fd >= 0;
+    }
+
+    void close() {
+        if (fd < 0)
+            return;
+        flush();
+        ::close(fd);
+        fd = -1;
+    }
+
+    // Start an event; add its fields with field() and finish with end()
+    void begin(const char* file, const char* function, int line, int level, const char* pattern, int64_t stamp, uint32_t thread) {
+        if (file_bytes + batch.size() >= max_bytes)
+            rotate();
+        auto key = std::make_tuple(file, function, line, level, pattern);
+        auto it = sites.find(key);
+        if (it == sites.end()) {
+            it = sites.emplace(key, static_cast<uint32_t>(sites.size())).first;
+            batch += static_cast<char>(SITE);
+            putVarint(batch, it->second);
+            batch += static_cast<char>(level);
+            putString(batch, file, std::strlen(file));
+            putString(batch, function, std::strlen(function));
+            putVarint(batch, static_cast<uint64_t>(line));
+            putString(batch, pattern, std::strlen(pattern));
+        }
+        batch += static_cast<char>(EVENT);
+        putVarint(batch, it->second);
+        putZigzag(batch, stamp - last_stamp);
+        last_stamp = stamp;
+        putVarint(batch, thread);
+    }
+
+    void field(const std::string& value) {
+        batch += static_cast<char>(STRING);
+        putString(batch, value.data(), value.size());
+    }
+
+    void field(bool value) {
+        batch += static_cast<char>(BOOL);
+        batch += static_cast<char>(value ? 1 : 0);
+    }
+
+    void field(double value) {
+        batch += static_cast<char>(DOUBLE);
+        char raw[8];
+        std::memcpy(raw, &value, 8);
+        batch.append(raw, 8);
+    }
+
+    template <typename T>
+    void field(const T& value) {
+        if constexpr (std::is_same<T, char>::value) {
+            field(std::string(1, value));
+        } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+            batch += static_cast<char>(INT);
+            putZigzag(batch, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral<T>::value) {
+            batch += static_cast<char>(UINT);
+            putVarint(batch, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_floating_point<T>::value) {
+            field(static_cast<double>(value));
+        } else {
+            std::ostringstream oss;
+            oss << value;
+            field(oss.str());
+        }
+    }
+
+    void end() {
+        batch += static_cast<char>(END);
+    }
+
+    void flush() {
+        if (fd < 0 || batch.empty())
+            return;
+        const char* data = batch.data();
+        size_t size = batch.size();
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        file_bytes += batch.size();
+        batch.clear();
+    }
+
+private:
+    std::string path;
+    uint64_t max_bytes = 0;
+    int keep_files = 0;
+    int fd = -1;
+    uint64_t file_bytes = 0;
+    int64_t last_stamp = 0;
+    std::string batch;
+    std::map<std::tuple<const char*, const char*, int, int, const char*>, uint32_t> sites;
+
+    void startFile() {
+        sites.clear();
+        file_bytes = 0;
+        last_stamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        batch.append(MAGIC, 4);
+        putVarint(batch, static_cast<uint64_t>(last_stamp));
+    }
+
+    // path -> path.1 -> ... -> path.<keep_files - 1>; the oldest is overwritten
+    void shiftFiles() {
+        for (int i = keep_files - 1; i >= 1; --i) {
+            std::string from = i == 1 ? path : path + "." + std::to_string(i - 1);
+            std::rename(from.c_str(), (path + "." + std::to_string(i)).c_str());
+        }
+    }
+
+    void rotate() {
+        flush();
+        if (fd >= 0)
+            ::close(fd);
+        shiftFiles();
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        startFile();
+    }
+};
+
+struct Field {
+    FieldType type = END;
+    int64_t i = 0;
+    uint64_t u = 0;
+    double d = 0;
+    std::string s;
+};
+
+struct Site {
+    int level = 0;
+    std::string file, function, pattern;
+    uint64_t line = 0;
+};
+
+struct Event {
+    const Site* site = nullptr;
+    int64_t stamp = 0;    // us since epoch
+    uint64_t thread = 0;
+    std::vector<Field> fields;
+};
+
+// Sequential reader over one file held in memory
+class Reader {
+public:
+    explicit Reader(std::string _data) : data(std::move(_data)) {
+        p = data.data();
+        end = p + data.size();
+        uint64_t start;
+        valid = data.size() >= 4 && std::memcmp(p, MAGIC, 4) == 0;
+        if (valid) {
+            p += 4;
+            valid = getVarint(p, end, start);
+            stamp = static_cast<int64_t>(start);
+        }
+    }
+
+    bool isValid() const {
+        return valid;
+    }
+
+    // False at the end of the file or at the first truncated record
+    bool next(Event& event) {
+        while (valid && p < end) {
+            uint8_t type = static_cast<uint8_t>(*p++);
+            if (type == SITE) {
+                uint64_t id, line;
+                Site site;
+                if (!getVarint(p, end, id) || p >= end)
+                    return false;
+                site.level = static_cast<uint8_t>(*p++);
+                if (!getString(p, end, site.file) || !getString(p, end, site.function) || !getVarint(p, end, line) || !getString(p, end, site.pattern))
+                    return false;
+                site.line = line;
+                sites[id] = std::move(site);
+            } else if (type == EVENT) {
+                uint64_t id;
+                int64_t delta;
+                if (!getVarint(p, end, id) || !getZigzag(p, end, delta) || !getVarint(p, end, event.thread))
+                    return false;
+                auto it = sites.find(id);
+                if (it == sites.end())
+                    return false;
+                stamp += delta;
+                event.site = &it->second;
+                event.stamp = stamp;
+                event.fields.clear();
+                while (true) {
+                    if (p >= end)
+                        return false;
+                    Field field;
+                    field.type = static_cast<FieldType>(*p++);
+                    if (field.type == END)
+                        break;
+                    bool ok = false;
+                    switch (field.type) {
+                        case INT: ok = getZigzag(p, end, field.i); break;
+                        case UINT: ok = getVarint(p, end, field.u); break;
+                        case DOUBLE:
+                            ok = end - p >= 8;
+                            if (ok) {
+                                std::memcpy(&field.d, p, 8);
+                                p += 8;
+                            }
+                            break;
+                        case STRING: ok = getString(p, end, field.s); break;
+                        case BOOL:
+                            ok = p < end;
+                            if (ok)
+                                field.u = static_cast<uint8_t>(*p++);
+                            break;
+                        default: break;
+                    }
+                    if (!ok)
+                        return false;
+                    event.fields.push_back(std::move(field));
+                }
+                return true;
+            } else {
+                return false;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::string data;
+    const char* p = nullptr;
+    const char* end = nullptr;
+    bool valid = false;
+    int64_t stamp = 0;
+    std::map<uint64_t, Site> sites;
+};
+
+} // namespace eventlog
+
+#endif // EVENTLOG_H
@@ -0,0 +1,78 @@
+#ifndef FALLDETECTOR_H
+#define FALLDETECTOR_H
+
+#include <cstdint>
+#include <cmath>
+#include "Configuration.h"
+#include "IMUSampleRing.h"
+
+struct FallEvent {
+    enum Phase { Provisional, Confirmed, Retracted };
+    Phase phase;
+    int64_t stamp_us;      // impact sample
+    int64_t freefall_us;   // length of the free-fall dip before the impact
+    float impact_g;
+};
+
+// Per-sample fall trigger on the raw accelerometer stream: the magnitude dips below freefall_g for at least
+// freefall_ms, then exceeds impact_g within impact_window_ms of the dip ending. Runs in O(1) per sample on the
+// IMU acquisition thread, so a provisional fall is known at the FIFO drain that brings in the impact.
+class FallDetector {
+public:
+    explicit FallDetector(const IMUConfig& imu_config)
+        : freefall_sq(square(imu_config.fall_freefall_g * imu_config.fall_counts_per_g)),
+          impact_sq(square(imu_config.fall_impact_g * imu_config.fall_counts_per_g)),
+          counts_per_g(imu_config.fall_counts_per_g),
+          freefall_min_us(static_cast<int64_t>(imu_config.fall_freefall_ms) * 1000),
+          impact_window_us(static_cast<int64_t>(imu_config.fall_impact_window_ms) * 1000) {}
+
+    // True when this sample is the impact of a fall; event is filled in as Provisional
+    bool add(const IMUSample& sample, FallEvent& event) {
+        double magnitude_sq = static_cast<double>(sample.x) * sample.x + static_cast<double>(sample.y) * sample.y + static_cast<double>(sample.z) * sample.z;
+        if (magnitude_sq < freefall_sq) {
+            if (freefall_start < 0)
+                freefall_start = sample.stamp_us;
+        } else if (freefall_start >= 0) {
+            if (sample.stamp_us - freefall_start >= freefall_min_us) {
+                armed_until = sample.stamp_us + impact_window_us;
+                freefall_length = sample.stamp_us - freefall_start;
+            }
+            freefall_start = -1;
+        }
+        if (armed_until < 0)
+            return false;
+        if (sample.stamp_us > armed_until) {
+            armed_until = -1;
+            return false;
+        }
+        if (magnitude_sq <= impact_sq)
+            return false;
+        armed_until = -1;
+        event.phase = FallEvent::Provisional;
+        event.stamp_us = sample.stamp_us;
+        event.freefall_us = freefall_length;
+        event.impact_g = static_cast<float>(std::sqrt(magnitude_sq) / counts_per_g);
+        return true;
+    }
+
+    void reset() {
+        freefall_start = -1;
+        armed_until = -1;
+    }
+
+private:
+    double freefall_sq;
+    double impact_sq;
+    double counts_per_g;
+    int64_t freefall_min_us;
+    int64_t impact_window_us;
+    int64_t freefall_start = -1;    // first sample of the current dip
+    int64_t freefall_length = 0;
+    int64_t armed_until = -1;       // an impact before this completes a fall
+
+    static double square(double value) {
+        return value * value;
+    }
+};
+
+#endif // FALLDETECTOR_H
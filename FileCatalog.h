@@ -0,0 +1,385 @@
+#ifndef FILECATALOG_H
+#define FILECATALOG_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <QImage>
+#include <QBuffer>
+#include <QByteArray>
+#include <QString>
+#include <poppler-qt5.h>
+#undef Status
+#include <opencv2/opencv.hpp>
+#include "Logger.h"
+#include "KeyframeIndex.h"
+
+// Background indexer for the Standalone todo folder. Keeps page count / duration / resolution / a small JPEG
+// thumbnail / validity for every .pdf, .txt and .mp4 in a compact on-disk catalog so the file browser never
+// has to open a file to describe it. Only files whose size or mtime changed are reindexed.
+class FileCatalog {
+public:
+    struct Entry {
+        std::string name;
+        std::string path;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        bool valid = false;
+        int32_t pages = 0;          // PDF pages, or TXT task lines
+        double duration_ms = 0.0;   // MP4 only
+        int32_t width = 0;
+        int32_t height = 0;
+        QByteArray thumbnail;       // JPEG, THUMB_WIDTH wide
+    };
+
+    static constexpr int THUMB_WIDTH = 96;
+
+    FileCatalog(const std::string& _catalog_path) : catalog_path(_catalog_path), running(false), stop_requested(false), rescan_pending(false) {
+        LOG_INFO("FileCatalog Constructor");
+        load();
+    }
+
+    ~FileCatalog() {
+        stop_requested = true;
+        if (indexer.joinable()) {
+            indexer.join();
+        }
+    }
+
+    FileCatalog(const FileCatalog&) = delete;
+    FileCatalog& operator=(const FileCatalog&) = delete;
+
+    // Called on the indexer thread when a scan (and any queued rescan) has finished
+    void setUpdatedCallback(std::function<void()> callback) {
+        updated_callback = callback;
+    }
+
+    // Rescan folder on the indexer thread; a request while a scan is running queues one more pass
+    void startIndexing(const std::string& _folder) {
+        try {
+            std::lock_guard<std::mutex> state_lock(state_mutex);
+            {
+                std::lock_guard<std::mutex> lock(entries_mutex);
+                folder = _folder;
+            }
+            if (running) {
+                rescan_pending = true;
+                return;
+            }
+            if (indexer.joinable()) {
+                indexer.join();
+            }
+            running = true;
+            indexer = std::thread([this]() { IndexLoop(); });
+        } catch (const std::exception& e) {
+            running = false;
+            LOG_ERROR("FileCatalog startIndexing error: " + std::string(e.what()));
+        }
+    }
+
+    bool isIndexing() const {
+        return running;
+    }
+
+    // True once the catalog describes folder (possibly from a previous session)
+    bool covers(const std::string& _folder) {
+        std::lock_guard<std::mutex> lock(entries_mutex);
+        return indexed_folder == _folder && !entries.empty();
+    }
+
+    // Snapshot of the entries with the given suffix, in the same order QDir lists them
+    std::vector<Entry> list(const std::string& suffix) {
+        std::vector<Entry> result;
+        {
+            std::lock_guard<std::mutex> lock(entries_mutex);
+            for (const auto& kv : entries) {
+                if (hasSuffix(kv.first, suffix))
+                    result.push_back(kv.second);
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const Entry& a, const Entry& b) {
+            return QString::fromStdString(a.name).compare(QString::fromStdString(b.name), Qt::CaseInsensitive) < 0;
+        });
+        return result;
+    }
+
+    bool lookup(const std::string& name, Entry& entry) {
+        std::lock_guard<std::mutex> lock(entries_mutex);
+        auto it = entries.find(name);
+        if (it == entries.end())
+            return false;
+        entry = it->second;
+        return true;
+    }
+
+private:
+    static constexpr uint32_t CATALOG_MAGIC = 0x31544143; // "CAT1"
+    std::string catalog_path;
+    std::string folder;
+    std::string indexed_folder;
+    std::map<std::string, Entry> entries;
+    std::mutex entries_mutex;
+    std::mutex state_mutex;                // running / rescan_pending handshake
+    std::thread indexer;
+    std::atomic<bool> running;
+    std::atomic<bool> stop_requested;
+    std::atomic<bool> rescan_pending;
+    std::function<void()> updated_callback;
+
+    static bool hasSuffix(const std::string& name, const std::string& suffix) {
+        return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    void IndexLoop() {
+        while (true) {
+            try {
+                scan();
+            } catch (const std::exception& e) {
+                LOG_ERROR("FileCatalog scan error: " + std::string(e.what()));
+            }
+            {
+                std::lock_guard<std::mutex> state_lock(state_mutex);
+                if (rescan_pending && !stop_requested) {
+                    rescan_pending = false;
+                    continue;
+                }
+                running = false;
+            }
+            // Only once running is cleared, so a callback that lists the catalog sees it as settled
+            if (updated_callback && !stop_requested)
+                updated_callback();
+            return;
+        }
+    }
+
+    void scan() {
+        namespace fs = std::filesystem;
+        auto scan_start = std::chrono::steady_clock::now();
+        std::string scan_folder;
+        std::map<std::string, Entry> current;
+        {
+            std::lock_guard<std::mutex> lock(entries_mutex);
+            scan_folder = folder;
+            if (indexed_folder == folder)
+                current = entries;
+        }
+        std::map<std::string, Entry> next;
+        int reindexed = 0;
+        std::error_code ec;
+        for (const auto& dirent : fs::directory_iterator(scan_folder, ec)) {
+            if (stop_requested)
+                return;
+            if (!dirent.is_regular_file(ec))
+                continue;
+            std::string name = dirent.path().filename().string();
+            if (!hasSuffix(name, ".pdf") && !hasSuffix(name, ".txt") && !hasSuffix(name, ".mp4"))
+                continue;
+            Entry entry;
+            entry.name = name;
+            entry.path = dirent.path().string();
+            entry.size = static_cast<uint64_t>(dirent.file_size(ec));
+            entry.mtime = static_cast<int64_t>(dirent.last_write_time(ec).time_since_epoch().count());
+            auto it = current.find(name);
+            if (it != current.end() && it->second.size == entry.size && it->second.mtime == entry.mtime) {
+                next[name] = it->second;
+                continue;
+            }
+            describe(entry);
+            reindexed++;
+            next[name] = entry;
+        }
+        if (ec) {
+            LOG_ERROR("FileCatalog can't list " + scan_folder + ": " + ec.message());
+            return;
+        }
+        bool changed = reindexed > 0 || next.size() != current.size();
+        {
+            std::lock_guard<std::mutex> lock(entries_mutex);
+            entries = std::move(next);
+            indexed_folder = scan_folder;
+        }
+        if (changed)
+            save();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - scan_start).count();
+        LOG_INFO("FileCatalog indexed " + scan_folder + ": " + std::to_string(reindexed) + " changed entries in " + std::to_string(ms) + " ms");
+    }
+
+    void describe(Entry& entry) {
+        try {
+            if (hasSuffix(entry.name, ".pdf"))
+                describePdf(entry);
+            else if (hasSuffix(entry.name, ".mp4"))
+                describeVideo(entry);
+            else
+                describeText(entry);
+        } catch (const std::exception& e) {
+            entry.valid = false;
+            LOG_ERROR("FileCatalog can't describe " + entry.name + ": " + std::string(e.what()));
+        }
+        if (!entry.valid)
+            LOG_WARN("FileCatalog: " + entry.name + " does not open");
+    }
+
+    void describePdf(Entry& entry) {
+        std::unique_ptr<Poppler::Document> doc(Poppler::Document::load(QString::fromStdString(entry.path)));
+        if (!doc || doc->isLocked() || doc->numPages() <= 0)
+            return;
+        entry.pages = doc->numPages();
+        std::unique_ptr<Poppler::Page> page(doc->page(0));
+        if (!page)
+            return;
+        QSizeF size = page->pageSizeF();   // points
+        entry.width = static_cast<int32_t>(size.width());
+        entry.height = static_cast<int32_t>(size.height());
+        double dpi = size.width() > 0 ? THUMB_WIDTH * 72.0 / size.width() : 10.0;
+        QImage image = page->renderToImage(dpi, dpi);
+        entry.valid = !image.isNull();
+        entry.thumbnail = encodeThumbnail(image);
+    }
+
+    void describeVideo(Entry& entry) {
+        cv::VideoCapture cap(entry.path);
+        if (!cap.isOpened())
+            return;
+        double fps = cap.get(cv::CAP_PROP_FPS);
+        double frames = cap.get(cv::CAP_PROP_FRAME_COUNT);
+        entry.width = static_cast<int32_t>(cap.get(cv::CAP_PROP_FRAME_WIDTH));
+        entry.height = static_cast<int32_t>(cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+        if (fps > 0 && frames > 0)
+            entry.duration_ms = frames * 1000.0 / fps;
+        // First frames are often black, take the thumbnail one second in when the clip is long enough
+        if (fps > 0 && frames > fps)
+            cap.set(cv::CAP_PROP_POS_FRAMES, fps);
+        cv::Mat frame;
+        if (!cap.read(frame) || frame.empty())
+            return;
+        entry.valid = true;
+        QImage image(frame.data, frame.cols, frame.rows, static_cast<int>(frame.step), QImage::Format_BGR888);
+        entry.thumbnail = encodeThumbnail(image);
+        cap.release();
+        // Build the seek index now so the first playback doesn't have to
+        KeyframeIndex keyframes;
+        keyframes.loadOrBuild(entry.path);
+    }
+
+    void describeText(Entry& entry) {
+        std::ifstream file(entry.path);
+        if (!file.is_open())
+            return;
+        std::string line;
+        int lines = 0;
+        while (std::getline(file, line)) {
+            if (line.find_first_not_of(" \t\r\n") != std::string::npos)
+                lines++;
+        }
+        entry.pages = lines;
+        entry.valid = true;
+    }
+
+    static QByteArray encodeThumbnail(const QImage& image) {
+        QByteArray bytes;
+        if (image.isNull())
+            return bytes;
+        QImage thumb = image.scaledToWidth(THUMB_WIDTH, Qt::SmoothTransformation);
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+        thumb.save(&buffer, "JPEG", 70);
+        return bytes;
+    }
+
+    template <typename T>
+    static void put(std::ofstream& out, const T& v) {
+        out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+
+    template <typename T>
+    static bool get(std::ifstream& in, T& v) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(v)));
+    }
+
+    static void putBytes(std::ofstream& out, const char* data, uint32_t len) {
+        put(out, len);
+        out.write(data, len);
+    }
+
+    static bool getBytes(std::ifstream& in, std::string& s) {
+        uint32_t len;
+        if (!get(in, len) || len > (1u << 24))
+            return false;
+        s.resize(len);
+        return static_cast<bool>(in.read(&s[0], len));
+    }
+
+    void save() {
+        try {
+            std::filesystem::create_directories(std::filesystem::path(catalog_path).parent_path());
+            std::string tmp = catalog_path + ".tmp";
+            {
+                std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+                if (!out.is_open()) {
+                    LOG_ERROR("FileCatalog can't write " + tmp);
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(entries_mutex);
+                put(out, CATALOG_MAGIC);
+                putBytes(out, indexed_folder.data(), static_cast<uint32_t>(indexed_folder.size()));
+                put(out, static_cast<uint32_t>(entries.size()));
+                for (const auto& kv : entries) {
+                    const Entry& e = kv.second;
+                    putBytes(out, e.name.data(), static_cast<uint32_t>(e.name.size()));
+                    put(out, e.size);
+                    put(out, e.mtime);
+                    put(out, static_cast<uint8_t>(e.valid));
+                    put(out, e.pages);
+                    put(out, e.duration_ms);
+                    put(out, e.width);
+                    put(out, e.height);
+                    putBytes(out, e.thumbnail.constData(), static_cast<uint32_t>(e.thumbnail.size()));
+                }
+            }
+            std::filesystem::rename(tmp, catalog_path);  // readers never see a half-written catalog
+        } catch (const std::exception& e) {
+            LOG_ERROR("FileCatalog save error: " + std::string(e.what()));
+        }
+    }
+
+    void load() {
+        std::ifstream in(catalog_path, std::ios::binary);
+        if (!in.is_open())
+            return;
+        uint32_t magic, count;
+        std::string loaded_folder;
+        if (!get(in, magic) || magic != CATALOG_MAGIC || !getBytes(in, loaded_folder) || !get(in, count))
+            return;
+        std::map<std::string, Entry> loaded;
+        for (uint32_t i = 0; i < count; ++i) {
+            Entry e;
+            uint8_t valid;
+            std::string thumb;
+            if (!getBytes(in, e.name) || !get(in, e.size) || !get(in, e.mtime) || !get(in, valid) || !get(in, e.pages) ||
+                !get(in, e.duration_ms) || !get(in, e.width) || !get(in, e.height) || !getBytes(in, thumb)) {
+                LOG_WARN("FileCatalog: truncated catalog, reindexing");
+                return;
+            }
+            e.valid = valid != 0;
+            e.path = (std::filesystem::path(loaded_folder) / e.name).string();
+            e.thumbnail = QByteArray(thumb.data(), static_cast<int>(thumb.size()));
+            loaded[e.name] = e;
+        }
+        std::lock_guard<std::mutex> lock(entries_mutex);
+        entries = std::move(loaded);
+        indexed_folder = loaded_folder;
+        LOG_INFO("FileCatalog loaded " + std::to_string(entries.size()) + " entries");
+    }
+};
+
+#endif // FILECATALOG_H
@@ -41,6 +41,7 @@ public:
  
     ~HTTPSession() {
         timer.stop();
+        push_handle.cancel();
         // bingtimer.stop();
         curl_global_cleanup();  // Global cleanup called once during object destruction
     }
@@ -184,11 +185,37 @@ public:
 
     void generate_notify() {
         // Start a timer that calls a update_status every 5000 ms (5 second)
-        timer.start(config.status_update, 0, [this]() { update_status(); });
+        timer.start(config.status_update, [this]() { update_status(); });
         // Start a timer that calls a send_ping every 5000 ms (1 second)
         // bingtimer.start(1000, [this]() { send_ping(); });
     }
 
+    // Send the current status now instead of at the next status_update tick (e.g. a provisional Fall). Runs on the
+    // same executor as the periodic update, so the two never overlap. Requests coalesce into the one queued push; one
+    // made while it is running makes it send again, so the latest status always goes out.
+    void push_status_now() {
+        {
+            std::lock_guard<std::mutex> lock(push_mutex);
+            push_again = true;
+            if (push_pending)
+                return;
+            push_pending = true;
+        }
+        push_handle = Scheduler::instance().schedule([this]() {
+            while (true) {
+                {
+                    std::lock_guard<std::mutex> lock(push_mutex);
+                    if (!push_again) {
+                        push_pending = false;
+                        return;
+                    }
+                    push_again = false;
+                }
+                update_status();
+            }
+        }, 0, 0, "network", "status-push");
+    }
+
     void stop_notify() {
         // Stop a timer
         timer.stop();
@@ -474,7 +501,11 @@ private:
     std::string Remote_IP;
     std::string operator_status;
     std::string old_status, current_status;
-    Timer timer;
+    Timer timer{"network", "status"};    // status POSTs may block on curl, keep them off the shared executor
+    TaskHandle push_handle;    // the only push that can be queued or running, see push_status_now()
+    std::mutex push_mutex;
+    bool push_pending = false;
+    bool push_again = false;
     // Timer bingtimer;
     std::function<void(nlohmann::json, std::string)> update_status_callback;
     nlohmann::json data;
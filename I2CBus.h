@@ -0,0 +1,186 @@
+#ifndef I2CBUS_H
+#define I2CBUS_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "Logger.h"
+
+// Register access to one I2C device. readRegs() reads n consecutive registers starting at reg in a single
+// transaction, so the device must have register auto-increment enabled for n > 1.
+class I2CBus {
+public:
+    virtual ~I2CBus() = default;
+
+    virtual bool readRegs(uint8_t reg, uint8_t* data, size_t n) = 0;
+    virtual bool writeReg(uint8_t reg, uint8_t value) = 0;
+
+    int readReg(uint8_t reg) {
+        uint8_t value;
+        return readRegs(reg, &value, 1) ? value : -1;
+    }
+
+    // Kernel round trips (ioctl/read/write) issued so far
+    uint64_t transfers() const {
+        return transfer_count;
+    }
+
+protected:
+    uint64_t transfer_count = 0;
+};
+
+// /dev/i2c-N backend: each register access is one I2C_RDWR ioctl (register address write + repeated start + read)
+class LinuxI2CBus : public I2CBus {
+public:
+    LinuxI2CBus(const std::string& _device, int _addr) : device(_device), addr(static_cast<uint16_t>(_addr)) {}
+
+    ~LinuxI2CBus() override {
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    bool open() {
+        fd = ::open(device.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0) {
+            LOG_ERROR("Can't open I2C device " + device + ": " + std::string(strerror(errno)));
+            return false;
+        }
+        return true;
+    }
+
+    bool readRegs(uint8_t reg, uint8_t* data, size_t n) override {
+        i2c_msg msgs[2];
+        msgs[0].addr = addr;
+        msgs[0].flags = 0;
+        msgs[0].len = 1;
+        msgs[0].buf = &reg;
+        msgs[1].addr = addr;
+        msgs[1].flags = I2C_M_RD;
+        msgs[1].len = static_cast<uint16_t>(n);
+        msgs[1].buf = data;
+        return transfer(msgs, 2);
+    }
+
+    bool writeReg(uint8_t reg, uint8_t value) override {
+        uint8_t buf[2] = {reg, value};
+        i2c_msg msg;
+        msg.addr = addr;
+        msg.flags = 0;
+        msg.len = 2;
+        msg.buf = buf;
+        return transfer(&msg, 1);
+    }
+
+private:
+    std::string device;
+    uint16_t addr;
+    int fd = -1;
+
+    bool transfer(i2c_msg* msgs, int count) {
+        i2c_rdwr_ioctl_data request;
+        request.msgs = msgs;
+        request.nmsgs = static_cast<uint32_t>(count);
+        ++transfer_count;
+        if (ioctl(fd, I2C_RDWR, &request) < 0) {
+            LOG_ERROR("I2C transfer failed: " + std::string(strerror(errno)));
+            return false;
+        }
+        return true;
+    }
+};
+
+// Replays a capture of the output register block without hardware. The file is raw bytes read back in order
+// by every read that starts at stream_reg (wrapping at the end); other registers behave as plain memory.
+// With emulateFifo() a level register reports how many frames have "arrived" in real time since they were last read.
+class ReplayI2CBus : public I2CBus {
+public:
+    ReplayI2CBus(const std::string& _path, uint8_t _stream_reg, uint8_t who_am_i_reg, uint8_t who_am_i)
+        : path(_path), stream_reg(_stream_reg) {
+        regs[who_am_i_reg] = who_am_i;
+    }
+
+    bool open() {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            LOG_ERROR("Can't open I2C replay file " + path);
+            return false;
+        }
+        stream.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        if (stream.empty()) {
+            LOG_ERROR("I2C replay file " + path + " is empty");
+            return false;
+        }
+        LOG_INFO("Replaying I2C data from " + path + " (" + std::to_string(stream.size()) + " bytes)");
+        return true;
+    }
+
+    // Level register layout of the LIS2DW12 FIFO_SAMPLES: bit 6 overrun, bits 5..0 unread frames
+    void emulateFifo(uint8_t _level_reg, int rate_hz, size_t _frame_bytes, size_t _depth) {
+        fifo = true;
+        level_reg = _level_reg;
+        frame_us = 1000000 / rate_hz;
+        frame_bytes = _frame_bytes;
+        depth = _depth;
+    }
+
+    bool readRegs(uint8_t reg, uint8_t* data, size_t n) override {
+        ++transfer_count;
+        if (fifo && reg == level_reg && n == 1) {
+            int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            if (fifo_start == 0)
+                fifo_start = now;
+            uint64_t arrived = static_cast<uint64_t>(now - fifo_start) / frame_us;
+            uint64_t pending = arrived - consumed;
+            bool overrun = pending > depth;
+            if (overrun)
+                consumed = arrived - depth;    // the sensor keeps only the newest frames
+            data[0] = static_cast<uint8_t>((overrun ? 0x40 : 0) | std::min<uint64_t>(pending, depth));
+            return true;
+        }
+        if (reg == stream_reg && !stream.empty()) {
+            if (fifo)
+                consumed += n / frame_bytes;
+            for (size_t i = 0; i < n; ++i) {
+                data[i] = static_cast<uint8_t>(stream[position]);
+                position = (position + 1) % stream.size();
+            }
+            return true;
+        }
+        for (size_t i = 0; i < n; ++i)
+            data[i] = regs[(reg + i) & 0xff];
+        return true;
+    }
+
+    bool writeReg(uint8_t reg, uint8_t value) override {
+        ++transfer_count;
+        regs[reg] = value;
+        return true;
+    }
+
+private:
+    std::string path;
+    uint8_t stream_reg;
+    uint8_t regs[256] = {};
+    std::vector<char> stream;
+    size_t position = 0;
+    bool fifo = false;
+    uint8_t level_reg = 0;
+    int64_t frame_us = 0;
+    size_t frame_bytes = 1;
+    size_t depth = 0;
+    int64_t fifo_start = 0;
+    uint64_t consumed = 0;
+};
+
+#endif // I2CBUS_H
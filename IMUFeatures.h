@@ -0,0 +1,86 @@
+#ifndef IMUFEATURES_H
+#define IMUFEATURES_H
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+// Sliding-window activity features in O(1) per sample. Samples are raw 16-bit sensor counts, so the running sums
+// Σa, Σa² and Σab are kept exactly in 64-bit integers: add/remove never accumulates rounding error, and the
+// moments are formed from exact numerators (N·Σa² − (Σa)²) before the single conversion to floating point.
+//
+// Layout matches the reference compute_features in imu_features_check.cpp (the model's training pipeline):
+// mean x,y,z | population std x,y,z | variance x,y,z | energy Σa² x,y,z | pearson r xy,yz,zx | p-values (0) xy,yz,zx
+class IMUFeatures {
+public:
+    static constexpr size_t COUNT = 18;
+
+    explicit IMUFeatures(size_t _window) : window(_window) {}
+
+    void add(int32_t x, int32_t y, int32_t z) {
+        update({x, y, z}, 1);
+        ++count;
+    }
+
+    // Must be given exactly the sample that leaves the window
+    void remove(int32_t x, int32_t y, int32_t z) {
+        update({x, y, z}, -1);
+        --count;
+    }
+
+    void clear() {
+        sum = {};
+        sum_sq = {};
+        sum_cross = {};
+        count = 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool full() const {
+        return count >= window;
+    }
+
+    std::vector<float> features() const {
+        std::vector<float> out(COUNT, 0.0f);
+        if (count == 0)
+            return out;
+        const double n = static_cast<double>(count);
+        std::array<int64_t, 3> spread;    // N² · variance
+        for (int a = 0; a < 3; ++a) {
+            spread[a] = static_cast<int64_t>(count) * sum_sq[a] - sum[a] * sum[a];
+            double variance = static_cast<double>(spread[a]) / (n * n);
+            out[a] = static_cast<float>(static_cast<double>(sum[a]) / n);
+            out[3 + a] = static_cast<float>(std::sqrt(variance));
+            out[6 + a] = static_cast<float>(variance);
+            out[9 + a] = static_cast<float>(sum_sq[a]);
+        }
+        for (int p = 0; p < 3; ++p) {
+            int a = p, b = (p + 1) % 3;    // xy, yz, zx
+            int64_t co = static_cast<int64_t>(count) * sum_cross[p] - sum[a] * sum[b];
+            double denom = std::sqrt(static_cast<double>(spread[a]) * static_cast<double>(spread[b]));
+            out[12 + p] = denom != 0 ? static_cast<float>(static_cast<double>(co) / denom) : 0.0f;
+        }
+        return out;
+    }
+
+private:
+    size_t window;
+    size_t count = 0;
+    std::array<int64_t, 3> sum = {};
+    std::array<int64_t, 3> sum_sq = {};
+    std::array<int64_t, 3> sum_cross = {};    // Σxy, Σyz, Σzx
+
+    void update(const std::array<int64_t, 3>& v, int64_t sign) {
+        for (int a = 0; a < 3; ++a) {
+            sum[a] += sign * v[a];
+            sum_sq[a] += sign * v[a] * v[a];
+            sum_cross[a] += sign * v[a] * v[(a + 1) % 3];
+        }
+    }
+};
+
+#endif // IMUFEATURES_H
@@ -0,0 +1,196 @@
+#ifndef IMUINFERENCE_H
+#define IMUINFERENCE_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <filesystem>
+#include <malloc.h>
+#include <onnxruntime_cxx_api.h>
+#include "Configuration.h"
+#include "Scheduler.h"
+
+// Persistent ONNX Runtime context for one activity model. Input and output tensors wrap buffers allocated once in
+// init() for up to max_batch windows and stay bound through an IoBinding, so run() only copies the features in and
+// calls the session; the binding is only redone when the batch size changes. Models with a fixed batch dimension of 1
+// run larger batches one window at a time. Not thread safe; the IMU acquisition thread is the only caller.
+class IMUInference {
+public:
+    static constexpr size_t FEATURES = 18;
+
+    explicit IMUInference(Ort::Env& _env) : env(_env) {}
+
+    bool init(const IMUConfig& imu_config, const IMUConfig::Model& model) {
+        try {
+            Ort::SessionOptions options;
+            // One intra-op thread runs the model on the caller; a pool of spinning workers would fight capture
+            options.SetIntraOpNumThreads(imu_config.ort_threads);
+            options.SetInterOpNumThreads(1);
+            options.AddConfigEntry("session.intra_op.allow_spinning", "0");
+            if (imu_config.ort_arena)
+                options.EnableCpuMemArena();
+            else
+                options.DisableCpuMemArena();
+
+            // A previously saved optimized model loads without running the optimizer again, unless the source model
+            // was replaced after it was written
+            std::string model_path = model.path;
+            if (cachedModelCurrent(model)) {
+                model_path = model.optimized_path;
+                options.SetGraphOptimizationLevel(ORT_DISABLE_ALL);
+            } else {
+                options.SetGraphOptimizationLevel(optimizationLevel(imu_config.ort_optimization));
+                if (!model.optimized_path.empty())
+                    options.SetOptimizedModelFilePath(model.optimized_path.c_str());
+            }
+            size_t heap_before = mallinfo2().uordblks;
+            auto started = std::chrono::steady_clock::now();
+            session = std::make_unique<Ort::Session>(env, model_path.c_str(), options);
+            LOG_INFO("IMU model " + model_path + " loaded in " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count()) + " ms");
+
+            Ort::AllocatorWithDefaultOptions allocator;
+            input_name = session->GetInputNameAllocated(0, allocator).get();
+            output_name = session->GetOutputNameAllocated(0, allocator).get();
+            auto output_info = session->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo();
+            output_type = output_info.GetElementType();
+            LOG_INFO("Model input name: " + input_name);
+            LOG_INFO("Model output name: " + output_name);
+            LOG_INFO("Output type: " + std::to_string(output_type));
+
+            std::vector<int64_t> input_dims = session->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+            max_batch = !input_dims.empty() && input_dims[0] > 0 ? static_cast<size_t>(input_dims[0]) : static_cast<size_t>(std::max(imu_config.max_batch, 1));
+            output_shape = output_info.GetShape();
+            if (output_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT)
+                classes = output_shape.size() > 1 && output_shape.back() > 0 ? static_cast<size_t>(output_shape.back()) : 3;
+            else if (output_type != ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64) {
+                LOG_ERROR("Unsupported IMU model output type " + std::to_string(output_type));
+                return false;
+            }
+            input.assign(max_batch * FEATURES, 0.0f);
+            output_labels.assign(max_batch, 0);
+            output_scores.assign(max_batch * classes, 0.0f);
+            binding = std::make_unique<Ort::IoBinding>(*session);
+            bind(1);
+            size_t heap_after = mallinfo2().uordblks;
+            load_bytes = heap_after > heap_before ? heap_after - heap_before : 0;
+        } catch (const Ort::Exception& e) {
+            LOG_ERROR("ONNX Runtime error: " + std::string(e.what()));
+            return false;
+        }
+        return true;
+    }
+
+    // batch windows of FEATURES floats each; label: 0 Work, 1 Relax, 2 Fall
+    void run(const float* features, size_t batch, int* labels, float* confidences) {
+        for (size_t done = 0; done < batch;) {
+            size_t chunk = std::min(batch - done, max_batch);
+            if (chunk != bound_batch)
+                bind(chunk);
+            std::copy(features + done * FEATURES, features + (done + chunk) * FEATURES, input.begin());
+            auto started = std::chrono::steady_clock::now();
+            session->Run(run_options, *binding);
+            latency.add(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count());
+            ++runs;
+            windows += chunk;
+
+            for (size_t i = 0; i < chunk; ++i) {
+                if (output_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64) {
+                    labels[done + i] = static_cast<int>(output_labels[i]) - 1;    // Match Python's -1 adjustment
+                    confidences[done + i] = 1.0f;                                  // No confidence score for integer outputs
+                } else {
+                    auto row = output_scores.begin() + i * classes;
+                    auto best = std::max_element(row, row + std::min<size_t>(classes, 3));
+                    labels[done + i] = static_cast<int>(best - row);
+                    confidences[done + i] = *best;
+                }
+            }
+            done += chunk;
+        }
+    }
+
+    size_t maxBatch() const {
+        return max_batch;
+    }
+
+    // Latency per session run and heap taken by loading
+    std::string summary() const {
+        return std::to_string(windows) + " windows in " + std::to_string(runs) + " runs, latency " + latency.summary() + ", load "
+               + std::to_string(load_bytes / 1024) + " KB";
+    }
+
+private:
+    Ort::Env& env;
+    std::unique_ptr<Ort::Session> session;
+    std::unique_ptr<Ort::IoBinding> binding;
+    Ort::RunOptions run_options{nullptr};
+    std::string input_name;
+    std::string output_name;
+    ONNXTensorElementDataType output_type = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+    size_t max_batch = 1;
+    size_t classes = 1;
+    size_t bound_batch = 0;
+    std::vector<float> input;
+    std::vector<int64_t> output_labels;
+    std::vector<float> output_scores;
+    std::array<int64_t, 2> input_shape{1, static_cast<int64_t>(FEATURES)};
+    std::vector<int64_t> output_shape;
+    Ort::Value input_tensor{nullptr};
+    Ort::Value output_tensor{nullptr};
+    LatencyHistogram latency;
+    uint64_t runs = 0;
+    uint64_t windows = 0;
+    size_t load_bytes = 0;    // process-wide heap growth across init(), so only indicative; measured once, never per run
+
+    // Tensors over the first batch rows of the preallocated buffers
+    void bind(size_t batch) {
+        Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        input_shape[0] = static_cast<int64_t>(batch);
+        if (!output_shape.empty())
+            output_shape[0] = static_cast<int64_t>(batch);
+        for (size_t dim = 1; dim < output_shape.size(); ++dim)
+            output_shape[dim] = output_shape[dim] > 0 ? output_shape[dim] : static_cast<int64_t>(classes);
+        input_tensor = Ort::Value::CreateTensor<float>(memory_info, input.data(), batch * FEATURES, input_shape.data(), input_shape.size());
+        if (output_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64)
+            output_tensor = Ort::Value::CreateTensor<int64_t>(memory_info, output_labels.data(), batch, output_shape.data(), output_shape.size());
+        else
+            output_tensor = Ort::Value::CreateTensor<float>(memory_info, output_scores.data(), batch * classes, output_shape.data(), output_shape.size());
+        binding->ClearBoundInputs();
+        binding->ClearBoundOutputs();
+        binding->BindInput(input_name.c_str(), input_tensor);
+        binding->BindOutput(output_name.c_str(), output_tensor);
+        bound_batch = batch;
+    }
+
+    static GraphOptimizationLevel optimizationLevel(const std::string& name) {
+        if (name == "disable")
+            return ORT_DISABLE_ALL;
+        if (name == "basic")
+            return ORT_ENABLE_BASIC;
+        if (name == "extended")
+            return ORT_ENABLE_EXTENDED;
+        return ORT_ENABLE_ALL;
+    }
+
+    // The saved optimized model exists and is at least as new as the model it was made from
+    static bool cachedModelCurrent(const IMUConfig::Model& model) {
+        if (model.optimized_path.empty())
+            return false;
+        std::error_code ec;
+        auto cached = std::filesystem::last_write_time(model.optimized_path, ec);
+        if (ec)
+            return false;
+        auto source = std::filesystem::last_write_time(model.path, ec);
+        if (ec)
+            return false;
+        if (source > cached) {
+            LOG_INFO("Optimized IMU model " + model.optimized_path + " is older than " + model.path + ", regenerating it");
+            return false;
+        }
+        return true;
+    }
+};
+
+#endif // IMUINFERENCE_H
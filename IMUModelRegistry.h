@@ -0,0 +1,95 @@
+#ifndef IMUMODELREGISTRY_H
+#define IMUMODELREGISTRY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "IMUInference.h"
+
+// The activity models configured under imu.models, run side by side on the same batch of windows. The first model
+// is primary: its labels drive the application. The others are shadows for A/B comparison (e.g. a quantized build);
+// their labels are only compared against the primary's.
+class IMUModelRegistry {
+public:
+    explicit IMUModelRegistry(Ort::Env& _env) : env(_env) {}
+
+    // Fails only if the primary model does not load; a shadow that fails is logged and left out
+    bool init(const IMUConfig& imu_config) {
+        entries.clear();
+        std::vector<IMUConfig::Model> models = imu_config.models;
+        if (models.empty())
+            models.push_back({"default", imu_config.imu_model_path, imu_config.ort_optimized_model_path});
+        for (const auto& model : models) {
+            Entry entry;
+            entry.name = model.name;
+            entry.inference = std::make_unique<IMUInference>(env);
+            if (!entry.inference->init(imu_config, model)) {
+                if (entries.empty()) {
+                    LOG_ERROR("IMU primary model " + model.name + " failed to load");
+                    return false;
+                }
+                LOG_ERROR("IMU shadow model " + model.name + " failed to load, skipping it");
+                continue;
+            }
+            entries.push_back(std::move(entry));
+        }
+        if (entries.empty()) {
+            LOG_ERROR("No IMU models configured");
+            return false;
+        }
+        LOG_INFO("IMU primary model " + entries[0].name + ", " + std::to_string(entries.size() - 1) + " shadow model(s)");
+        return true;
+    }
+
+    // Most windows the primary takes in one session run
+    size_t maxBatch() const {
+        return entries.empty() ? 1 : entries[0].inference->maxBatch();
+    }
+
+    // features holds batch windows of IMUInference::FEATURES floats; labels and confidences come from the primary,
+    // or are -1 / 0 while no model is loaded
+    void run(const float* features, size_t batch, int* labels, float* confidences) {
+        if (entries.empty()) {
+            std::fill(labels, labels + batch, -1);
+            std::fill(confidences, confidences + batch, 0.0f);
+            return;
+        }
+        entries[0].inference->run(features, batch, labels, confidences);
+        for (size_t m = 1; m < entries.size(); ++m) {
+            Entry& shadow = entries[m];
+            shadow.labels.resize(batch);
+            shadow.confidences.resize(batch);
+            shadow.inference->run(features, batch, shadow.labels.data(), shadow.confidences.data());
+            for (size_t i = 0; i < batch; ++i)
+                shadow.agreed += shadow.labels[i] == labels[i];
+            shadow.compared += batch;
+        }
+    }
+
+    std::string summary() const {
+        std::string out;
+        for (size_t m = 0; m < entries.size(); ++m) {
+            const Entry& entry = entries[m];
+            out += (m ? "\n  shadow " : "  primary ") + entry.name + ": " + entry.inference->summary();
+            if (m && entry.compared > 0)
+                out += ", agrees with primary on " + std::to_string(100.0 * entry.agreed / entry.compared).substr(0, 5) + "% of " + std::to_string(entry.compared) + " windows";
+        }
+        return out;
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        std::unique_ptr<IMUInference> inference;
+        std::vector<int> labels;
+        std::vector<float> confidences;
+        uint64_t compared = 0;
+        uint64_t agreed = 0;
+    };
+
+    Ort::Env& env;
+    std::vector<Entry> entries;
+};
+
+#endif // IMUMODELREGISTRY_H
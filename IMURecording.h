@@ -0,0 +1,159 @@
+#ifndef IMURECORDING_H
+#define IMURECORDING_H
+
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <array>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "EventLog.h"
+#include "Logger.h"
+
+// Raw accelerometer capture for replaying the IMU pipeline without the helmet.
+//
+// File:   "IMR1" magic, varint odr_hz, varint wall-clock start (us since epoch), then one record per sample
+// Sample: zigzag varint (interval us - 1e6 / odr_hz), zigzag varint x, y, z deltas from the previous sample (raw counts)
+// At a steady ODR and a slowly moving sensor a sample takes 4-6 bytes instead of 14.
+
+class IMURecorder {
+public:
+    ~IMURecorder() {
+        close();
+    }
+
+    // Truncates an existing file
+    bool open(const std::string& path, int odr_hz) {
+        close();
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            LOG_ERROR("Can't open IMU recording " + path + ": " + std::string(strerror(errno)));
+            return false;
+        }
+        period_us = 1000000 / odr_hz;
+        started = false;
+        buffer.append(RECORDING_MAGIC, 4);
+        eventlog::putVarint(buffer, static_cast<uint64_t>(odr_hz));
+        eventlog::putVarint(buffer, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+        LOG_INFO("Recording IMU samples to " + path);
+        return true;
+    }
+
+    bool isOpen() const {
+        return fd >= 0;
+    }
+
+    void append(int64_t stamp_us, int16_t x, int16_t y, int16_t z) {
+        if (fd < 0)
+            return;
+        if (!started) {
+            last = {stamp_us - period_us, 0, 0, 0};
+            started = true;
+        }
+        eventlog::putZigzag(buffer, stamp_us - last[0] - period_us);
+        eventlog::putZigzag(buffer, x - last[1]);
+        eventlog::putZigzag(buffer, y - last[2]);
+        eventlog::putZigzag(buffer, z - last[3]);
+        last = {stamp_us, x, y, z};
+    }
+
+    void flush() {
+        if (fd < 0 || buffer.empty())
+            return;
+        const char* data = buffer.data();
+        size_t size = buffer.size();
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                LOG_ERROR("IMU recording write failed: " + std::string(strerror(errno)));
+                break;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        buffer.clear();
+    }
+
+    void close() {
+        if (fd < 0)
+            return;
+        flush();
+        ::close(fd);
+        fd = -1;
+    }
+
+    static constexpr char RECORDING_MAGIC[4] = {'I', 'M', 'R', '1'};
+
+private:
+    int fd = -1;
+    int64_t period_us = 20000;
+    bool started = false;
+    std::array<int64_t, 4> last = {};    // stamp, x, y, z
+    std::string buffer;
+};
+
+// Sequential reader; stamps start at 0 for the first sample
+class IMURecordingReader {
+public:
+    bool open(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            LOG_ERROR("Can't open IMU recording " + path);
+            return false;
+        }
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        p = data.data();
+        end = p + data.size();
+        uint64_t odr, start;
+        if (data.size() < 4 || std::memcmp(p, IMURecorder::RECORDING_MAGIC, 4) != 0) {
+            LOG_ERROR(path + " is not an IMU recording");
+            return false;
+        }
+        p += 4;
+        if (!eventlog::getVarint(p, end, odr) || odr == 0 || !eventlog::getVarint(p, end, start))
+            return false;
+        odr_hz = static_cast<int>(odr);
+        start_us = static_cast<int64_t>(start);
+        period_us = 1000000 / odr_hz;
+        last = {-period_us, 0, 0, 0};
+        return true;
+    }
+
+    // False at the end of the file or at a truncated record
+    bool next(int64_t& stamp_us, int16_t& x, int16_t& y, int16_t& z) {
+        int64_t delta[4];
+        const char* record = p;
+        for (auto& value : delta) {
+            if (!eventlog::getZigzag(p, end, value)) {
+                p = record;
+                return false;
+            }
+        }
+        last[0] += delta[0] + period_us;
+        for (int axis = 1; axis < 4; ++axis)
+            last[axis] += delta[axis];
+        stamp_us = last[0];
+        x = static_cast<int16_t>(last[1]);
+        y = static_cast<int16_t>(last[2]);
+        z = static_cast<int16_t>(last[3]);
+        return true;
+    }
+
+    int odr_hz = 0;
+    int64_t start_us = 0;    // wall clock, us since epoch
+
+private:
+    std::string data;
+    const char* p = nullptr;
+    const char* end = nullptr;
+    int64_t period_us = 20000;
+    std::array<int64_t, 4> last = {};
+};
+
+#endif // IMURECORDING_H
@@ -0,0 +1,50 @@
+#ifndef IMUSAMPLERING_H
+#define IMUSAMPLERING_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+struct IMUSample {
+    int64_t stamp_us;    // steady clock, on the sensor's ODR grid
+    float x, y, z;
+};
+
+// Fixed-capacity ring of the most recent accelerometer samples. Owned by the IMU acquisition thread; not thread safe.
+class IMUSampleRing {
+public:
+    explicit IMUSampleRing(size_t _capacity) : samples(_capacity) {}
+
+    void push(const IMUSample& sample) {
+        samples[total % samples.size()] = sample;
+        ++total;
+    }
+
+    void clear() {
+        total = 0;
+    }
+
+    size_t size() const {
+        return total < samples.size() ? static_cast<size_t>(total) : samples.size();
+    }
+
+    size_t capacity() const {
+        return samples.size();
+    }
+
+    // Samples pushed since construction or clear(), including overwritten ones
+    uint64_t pushed() const {
+        return total;
+    }
+
+    // i-th sample counted back from the newest (0 = newest); i must be < size()
+    const IMUSample& back(size_t i = 0) const {
+        return samples[(total - 1 - i) % samples.size()];
+    }
+
+private:
+    std::vector<IMUSample> samples;
+    uint64_t total = 0;
+};
+
+#endif // IMUSAMPLERING_H
@@ -0,0 +1,349 @@
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <algorithm>
+#include <filesystem>
+#include <chrono>
+#include "Logger.h"
+
+// Per-file map of presentation timestamps to sync samples (keyframes) of the first video track of an MP4/MOV file.
+// Built from the stts/ctts/stss sample tables and the edit list the first time a video is opened and cached next to
+// it as <video>.kfi. Times start at the first presented frame, like the decoder's CAP_PROP_POS_MSEC.
+class KeyframeIndex {
+public:
+    struct Keyframe {
+        double time_ms;    // presentation time
+        int64_t frame;     // 0-based sample number in decode order
+    };
+
+    bool loadOrBuild(const std::string& _video_path) {
+        try {
+            clear();
+            video_path = _video_path;
+            std::error_code ec;
+            source_size = static_cast<uint64_t>(std::filesystem::file_size(video_path, ec));
+            if (ec) {
+                LOG_ERROR("KeyframeIndex can't stat " + video_path);
+                return false;
+            }
+            source_mtime = static_cast<int64_t>(std::filesystem::last_write_time(video_path, ec).time_since_epoch().count());
+            if (load())
+                return true;
+            auto build_start = std::chrono::steady_clock::now();
+            if (!build()) {
+                LOG_WARN("KeyframeIndex: no usable sample tables in " + video_path);
+                clear();
+                return false;
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - build_start).count();
+            LOG_INFO("KeyframeIndex built " + std::to_string(keyframes.size()) + " keyframes in " + std::to_string(ms) + " ms");
+            save();
+            return true;
+        } catch (const std::exception& e) {
+            LOG_ERROR("KeyframeIndex loadOrBuild error: " + std::string(e.what()));
+            clear();
+            return false;
+        }
+    }
+
+    bool empty() const {
+        return keyframes.empty();
+    }
+
+    size_t size() const {
+        return keyframes.size();
+    }
+
+    double durationMs() const {
+        return duration_ms;
+    }
+
+    // Nearest keyframe at or before time_ms
+    Keyframe lookup(double time_ms) const {
+        if (keyframes.empty())
+            return {0.0, 0};
+        auto it = std::upper_bound(keyframes.begin(), keyframes.end(), time_ms,
+                                   [](double t, const Keyframe& k) { return t < k.time_ms; });
+        if (it == keyframes.begin())
+            return keyframes.front();
+        return *(it - 1);
+    }
+
+    void clear() {
+        keyframes.clear();
+        duration_ms = 0.0;
+    }
+
+private:
+    static constexpr uint32_t CACHE_MAGIC = 0x3349464B; // "KFI3"
+    std::string video_path;
+    uint64_t source_size = 0;
+    int64_t source_mtime = 0;
+    double duration_ms = 0.0;
+    std::vector<Keyframe> keyframes;
+
+    struct Box {
+        uint32_t type;
+        uint64_t payload;   // file offset of the payload
+        uint64_t end;       // file offset just past the box
+    };
+
+    std::string cachePath() const {
+        return video_path + ".kfi";
+    }
+
+    bool load() {
+        std::ifstream in(cachePath(), std::ios::binary);
+        if (!in.is_open())
+            return false;
+        uint32_t magic = 0, count = 0;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+        in.read(reinterpret_cast<char*>(&size), sizeof(size));
+        in.read(reinterpret_cast<char*>(&mtime), sizeof(mtime));
+        in.read(reinterpret_cast<char*>(&duration_ms), sizeof(duration_ms));
+        in.read(reinterpret_cast<char*>(&count), sizeof(count));
+        if (!in || magic != CACHE_MAGIC || size != source_size || mtime != source_mtime) {
+            clear();
+            return false;
+        }
+        keyframes.resize(count);
+        in.read(reinterpret_cast<char*>(keyframes.data()), static_cast<std::streamsize>(count * sizeof(Keyframe)));
+        if (!in) {
+            clear();
+            return false;
+        }
+        return true;
+    }
+
+    void save() const {
+        std::ofstream out(cachePath(), std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            LOG_WARN("KeyframeIndex can't write cache " + cachePath());
+            return;
+        }
+        uint32_t count = static_cast<uint32_t>(keyframes.size());
+        out.write(reinterpret_cast<const char*>(&CACHE_MAGIC), sizeof(CACHE_MAGIC));
+        out.write(reinterpret_cast<const char*>(&source_size), sizeof(source_size));
+        out.write(reinterpret_cast<const char*>(&source_mtime), sizeof(source_mtime));
+        out.write(reinterpret_cast<const char*>(&duration_ms), sizeof(duration_ms));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char*>(keyframes.data()), static_cast<std::streamsize>(count * sizeof(Keyframe)));
+    }
+
+    static constexpr uint32_t fourcc(const char (&s)[5]) {
+        return (uint32_t(uint8_t(s[0])) << 24) | (uint32_t(uint8_t(s[1])) << 16) | (uint32_t(uint8_t(s[2])) << 8) | uint32_t(uint8_t(s[3]));
+    }
+
+    static bool readU32(std::ifstream& in, uint32_t& v) {
+        uint8_t b[4];
+        if (!in.read(reinterpret_cast<char*>(b), 4))
+            return false;
+        v = (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | uint32_t(b[3]);
+        return true;
+    }
+
+    static bool readU64(std::ifstream& in, uint64_t& v) {
+        uint32_t hi, lo;
+        if (!readU32(in, hi) || !readU32(in, lo))
+            return false;
+        v = (uint64_t(hi) << 32) | lo;
+        return true;
+    }
+
+    // Box header at pos, bounded by limit
+    static bool readBox(std::ifstream& in, uint64_t pos, uint64_t limit, Box& box) {
+        if (pos + 8 > limit)
+            return false;
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(pos));
+        uint32_t size32, type;
+        if (!readU32(in, size32) || !readU32(in, type))
+            return false;
+        uint64_t size = size32;
+        uint64_t header = 8;
+        if (size32 == 1) {
+            if (!readU64(in, size))
+                return false;
+            header = 16;
+        } else if (size32 == 0) {
+            size = limit - pos;
+        }
+        if (size < header || pos + size > limit)
+            return false;
+        box = {type, pos + header, pos + size};
+        return true;
+    }
+
+    static bool findChild(std::ifstream& in, const Box& parent, uint32_t type, Box& child) {
+        uint64_t pos = parent.payload;
+        Box box;
+        while (readBox(in, pos, parent.end, box)) {
+            if (box.type == type) {
+                child = box;
+                return true;
+            }
+            pos = box.end;
+        }
+        return false;
+    }
+
+    bool build() {
+        std::ifstream in(video_path, std::ios::binary);
+        if (!in.is_open())
+            return false;
+        Box file{0, 0, source_size}, moov;
+        if (!findChild(in, file, fourcc("moov"), moov))
+            return false;
+        uint64_t pos = moov.payload;
+        Box trak;
+        while (readBox(in, pos, moov.end, trak)) {
+            pos = trak.end;
+            if (trak.type == fourcc("trak") && parseVideoTrak(in, trak))
+                return !keyframes.empty();
+        }
+        return false;
+    }
+
+    bool parseVideoTrak(std::ifstream& in, const Box& trak) {
+        Box mdia, hdlr, mdhd, minf, stbl, stts;
+        if (!findChild(in, trak, fourcc("mdia"), mdia) || !findChild(in, mdia, fourcc("hdlr"), hdlr))
+            return false;
+        // hdlr: version/flags(4) pre_defined(4) handler_type(4)
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(hdlr.payload + 8));
+        uint32_t handler;
+        if (!readU32(in, handler) || handler != fourcc("vide"))
+            return false;
+        if (!findChild(in, mdia, fourcc("mdhd"), mdhd) || !findChild(in, mdia, fourcc("minf"), minf) ||
+            !findChild(in, minf, fourcc("stbl"), stbl) || !findChild(in, stbl, fourcc("stts"), stts))
+            return false;
+
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(mdhd.payload));
+        uint32_t version_flags, timescale;
+        if (!readU32(in, version_flags))
+            return false;
+        in.seekg((version_flags >> 24) == 1 ? 16 : 8, std::ios::cur); // creation/modification times
+        if (!readU32(in, timescale) || timescale == 0)
+            return false;
+
+        // Decode timestamps of every sample from the time-to-sample runs
+        std::vector<uint64_t> sample_times;
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(stts.payload + 4));
+        uint32_t entries;
+        if (!readU32(in, entries))
+            return false;
+        uint64_t t = 0;
+        for (uint32_t i = 0; i < entries; ++i) {
+            uint32_t count, delta;
+            if (!readU32(in, count) || !readU32(in, delta))
+                return false;
+            for (uint32_t j = 0; j < count; ++j) {
+                sample_times.push_back(t);
+                t += delta;
+            }
+        }
+        if (sample_times.empty())
+            return false;
+        duration_ms = t * 1000.0 / timescale;
+
+        // Presentation times: B-frame streams reorder samples by their composition offsets (ctts), and the edit list
+        // (elst) says which composition time is shown first. Without an edit list the earliest one is.
+        std::vector<int64_t> present(sample_times.begin(), sample_times.end());
+        Box ctts;
+        if (findChild(in, stbl, fourcc("ctts"), ctts)) {
+            in.clear();
+            in.seekg(static_cast<std::streamoff>(ctts.payload + 4));
+            if (!readU32(in, entries))
+                return false;
+            size_t sample = 0;
+            for (uint32_t i = 0; i < entries && sample < present.size(); ++i) {
+                uint32_t count, offset;
+                if (!readU32(in, count) || !readU32(in, offset))
+                    return false;
+                // Unsigned in version 0, signed in version 1; muxers write negative offsets in both
+                for (uint32_t j = 0; j < count && sample < present.size(); ++j)
+                    present[sample++] += static_cast<int32_t>(offset);
+            }
+        }
+        int64_t first_shown = *std::min_element(present.begin(), present.end());
+        int64_t media_time;
+        if (editStart(in, trak, media_time))
+            first_shown = media_time;
+
+        Box stss;
+        if (!findChild(in, stbl, fourcc("stss"), stss)) {
+            // No sync sample table: every sample is a keyframe
+            for (size_t i = 0; i < present.size(); ++i)
+                keyframes.push_back({presentationMs(present[i], first_shown, timescale), static_cast<int64_t>(i)});
+            sortKeyframes();
+            return true;
+        }
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(stss.payload + 4));
+        if (!readU32(in, entries))
+            return false;
+        keyframes.reserve(entries);
+        for (uint32_t i = 0; i < entries; ++i) {
+            uint32_t sample;   // 1-based
+            if (!readU32(in, sample))
+                return false;
+            if (sample == 0 || sample > sample_times.size())
+                continue;
+            keyframes.push_back({presentationMs(present[sample - 1], first_shown, timescale), static_cast<int64_t>(sample - 1)});
+        }
+        sortKeyframes();
+        return true;
+    }
+
+    static double presentationMs(int64_t time, int64_t first_shown, uint32_t timescale) {
+        return std::max<int64_t>(time - first_shown, 0) * 1000.0 / timescale;
+    }
+
+    // Open-GOP streams can present a keyframe before the one decoded ahead of it
+    void sortKeyframes() {
+        std::stable_sort(keyframes.begin(), keyframes.end(),
+                         [](const Keyframe& a, const Keyframe& b) { return a.time_ms < b.time_ms; });
+    }
+
+    // Media time of the first non-empty edit in trak/edts/elst, in the track's timescale
+    static bool editStart(std::ifstream& in, const Box& trak, int64_t& media_time) {
+        Box edts, elst;
+        if (!findChild(in, trak, fourcc("edts"), edts) || !findChild(in, edts, fourcc("elst"), elst))
+            return false;
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(elst.payload));
+        uint32_t version_flags, entries;
+        if (!readU32(in, version_flags) || !readU32(in, entries))
+            return false;
+        bool wide = (version_flags >> 24) == 1;
+        for (uint32_t i = 0; i < entries; ++i) {
+            // segment_duration, media_time (-1 marks an empty edit), media_rate(4)
+            uint64_t duration, time;
+            uint32_t duration32, time32, rate;
+            if (wide) {
+                if (!readU64(in, duration) || !readU64(in, time))
+                    return false;
+                media_time = static_cast<int64_t>(time);
+            } else {
+                if (!readU32(in, duration32) || !readU32(in, time32))
+                    return false;
+                media_time = static_cast<int32_t>(time32);
+            }
+            if (!readU32(in, rate))
+                return false;
+            if (media_time >= 0)
+                return true;
+        }
+        return false;
+    }
+};
+
+#endif // KEYFRAMEINDEX_H
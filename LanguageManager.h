@@ -6,6 +6,7 @@
 #include <sstream>
 #include <string>
 #include <map>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include <stdexcept>
 #include <algorithm>
@@ -73,7 +74,8 @@ public:
 
      }
 
-    std::string getGrammar() {
+    // Command words of the current language, plus extra phrases such as "search <term>"
+    std::string getGrammar(const std::vector<std::string>& extra_phrases = {}) {
         try {
             const json& grammar = translations["grammar"];
             if (!grammar.is_array()) {
@@ -87,6 +89,8 @@ public:
                 std::string word = grammar[i].get<std::string>();
                 oss << "\"" << word << "\"";
             }
+            for (const auto& phrase : extra_phrases)
+                oss << "," << json(phrase).dump();
             oss << "]";
             return oss.str();
         } catch (const json::exception& e) {
@@ -95,6 +99,20 @@ public:
         }
     }
 
+    // String array of the current language, e.g. "digits"; empty if missing
+    std::vector<std::string> getList(const std::string& key) {
+        std::vector<std::string> items;
+        try {
+            const json& list = translations[key];
+            if (list.is_array())
+                for (const auto& item : list)
+                    items.push_back(item.get<std::string>());
+        } catch (const json::exception& e) {
+            LOG_ERROR("Failed to get list: " + key + ", error: " + std::string(e.what()));
+        }
+        return items;
+    }
+
     std::string getSection(const std::string& section) {
         try {
             return translations[section].dump();
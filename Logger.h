@@ -4,50 +4,546 @@
 #include <iostream>
 #include <string>
 #include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <stdexcept>
 #include <array>
+#include <vector>
+#include <memory>
+#include <map>
+#include <tuple>
+#include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include <fstream>
 #include <ctime>
 #include <chrono>
 #include <iomanip>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include "EventLog.h"
+
+// Asynchronous logger. Each calling thread formats its record and pushes it into its own lock-free single-producer
+// ring; one background thread drains all rings, merges them by timestamp and appends the batch to FOLOG.log through a
+// descriptor that stays open. A full ring drops the record and counts it instead of blocking the caller. Queued records
+// are flushed at exit and, best effort, when the process dies on a fatal signal.
+// The LOG_* macros check the level before evaluating their arguments: statements below LOG_COMPILE_LEVEL compile away
+// and statements below the runtime level of their module (source file name) cost one cached comparison. The LOG_*F
+// variants take a "{}" format string whose arguments are copied and formatted on the writer thread.
+// After useEventLog() the writer emits compact binary events (see EventLog.h) instead of text lines.
 class Logger {
 public:
+    enum Level { LEVEL_DEBUG = 0, LEVEL_INFO, LEVEL_WARN, LEVEL_ERROR, LEVEL_OFF };
+
+    // Per call site cache of the level that applies to its module; constant-initialized, so no static guard
+    class Site {
+    public:
+        constexpr explicit Site(const char* _file) : file(_file), cached(0) {}
+
+        bool enabled(int level) {
+            uint32_t generation = levelsGeneration().load(std::memory_order_acquire);
+            uint64_t value = cached.load(std::memory_order_relaxed);
+            if (static_cast<uint32_t>(value >> 8) != generation) {
+                value = (static_cast<uint64_t>(generation) << 8) | static_cast<uint64_t>(moduleLevel(file));
+                cached.store(value, std::memory_order_relaxed);
+            }
+            return level >= static_cast<int>(value & 0xff);
+        }
+
+    private:
+        const char* file;
+        std::atomic<uint64_t> cached;    // generation << 8 | level
+    };
+
+    // Runtime threshold, with overrides per module name ("camera_viewer", "imu_classifier_thread", ...)
+    static void setLevels(int default_level, const std::map<std::string, int>& modules) {
+        {
+            std::lock_guard<std::mutex> lock(levelsMutex());
+            defaultLevel() = default_level;
+            moduleLevels() = modules;
+        }
+        // Generation 0 means "not resolved yet" for every Site
+        levelsGeneration().fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    static int parseLevel(const std::string& name, int fallback = LEVEL_INFO) {
+        std::string upper = name;
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        if (upper == "DEBUG") return LEVEL_DEBUG;
+        if (upper == "INFO") return LEVEL_INFO;
+        if (upper == "WARN" || upper == "WARNING") return LEVEL_WARN;
+        if (upper == "ERROR") return LEVEL_ERROR;
+        if (upper == "OFF") return LEVEL_OFF;
+        return fallback;
+    }
+
+    static void logDebugImpl(const std::string &message, const char* file, const char* function, int line) {
+        log(LEVEL_DEBUG, message, file, function, line);
+    }
+
     static void logInfoImpl(const std::string &message, const char* file, const char* function, int line) {
-        log("INFO", message, file, function, line);
+        log(LEVEL_INFO, message, file, function, line);
     }
 
     static void logErrorImpl(const std::string &message, const char* file, const char* function, int line) {
-        log("ERROR", message, file, function, line);
+        log(LEVEL_ERROR, message, file, function, line);
     }
 
     static void logWarnImpl(const std::string &message, const char* file, const char* function, int line) {
-        log("WARN", message, file, function, line);
+        log(LEVEL_WARN, message, file, function, line);
+    }
+
+    template <typename... Args>
+    static void logFormat(int level, const char* file, const char* function, int line, const char* format, Args&&... args) {
+        Record record = makeRecord(level, file, function, line);
+        record.deferred.reset(new DeferredFormat<typename Stored<Args>::type...>(format, std::forward<Args>(args)...));
+        enqueue(std::move(record));
+    }
+
+    // Switch from FOLOG.log text to binary events in path, rotated every max_bytes and keeping keep_files files.
+    // FOLOG.log stays open for the fatal signal flush.
+    static bool useEventLog(const std::string& path, uint64_t max_bytes, int keep_files) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.drain_mutex);
+        return s.events.open(path, max_bytes, keep_files);
+    }
+
+    // Write everything queued so far
+    static void flush() {
+        drainAll(state());
+    }
+
+    // Records lost because a thread's ring was full
+    static size_t dropped() {
+        return state().dropped_total.load(std::memory_order_relaxed);
     }
 
 private:
-    static void log(const std::string &level, const std::string &message, const char* file, const char* function, int line) {
-        std::ofstream logFile("/home/x_user/my_camera_project/FOLOG.log", std::ios::app);
-        if (logFile.is_open()) {
-            auto now = std::chrono::system_clock::now();
-            auto seconds = std::chrono::time_point_cast<std::chrono::seconds>(now);
-            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - seconds).count();
-            std::time_t now_t = std::chrono::system_clock::to_time_t(seconds);
-            std::tm* local_tm = std::localtime(&now_t);
-            char buf[100];
-            std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", local_tm);
+    static constexpr const char* LOG_PATH = "/home/x_user/my_camera_project/FOLOG.log";
+    // Per logging thread (~80 bytes a slot); bursts beyond it wake the writer at half full, then count as dropped
+    static constexpr size_t RING_SLOTS = 256;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{100};
+
+    // Message whose formatting is left to the writer thread
+    struct Deferred {
+        virtual ~Deferred() = default;
+        virtual std::string format() const = 0;
+        virtual const char* pattern() const = 0;
+        virtual void encode(eventlog::Writer& writer) const = 0;
+    };
+
+    // Arguments are stored by value; C strings are copied since the caller's buffer may be gone by then
+    template <typename T, typename D = std::decay_t<T>>
+    struct Stored {
+        using type = std::conditional_t<std::is_same<D, const char*>::value || std::is_same<D, char*>::value, std::string, D>;
+    };
+
+    template <typename... Args>
+    struct DeferredFormat : Deferred {
+        const char* format_string;
+        std::tuple<Args...> args;
+
+        template <typename... In>
+        explicit DeferredFormat(const char* _format, In&&... in) : format_string(_format), args(std::forward<In>(in)...) {}
+
+        std::string format() const override {
+            std::string out;
+            const char* rest = format_string;
+            std::apply([&](const auto&... arg) { (formatNext(out, rest, arg), ...); }, args);
+            out += rest;
+            return out;
+        }
+
+        const char* pattern() const override {
+            return format_string;
+        }
+
+        // Typed fields; the pattern is stored once per call site
+        void encode(eventlog::Writer& writer) const override {
+            std::apply([&](const auto&... arg) { (writer.field(arg), ...); }, args);
+        }
+    };
+
+    // Copy the pattern up to the next "{}" and substitute one argument for it
+    template <typename T>
+    static void formatNext(std::string& out, const char*& rest, const T& arg) {
+        const char* hole = std::strstr(rest, "{}");
+        if (!hole)
+            return;
+        out.append(rest, hole);
+        rest = hole + 2;
+        if constexpr (std::is_same<T, std::string>::value) {
+            out += arg;
+        } else if constexpr (std::is_same<T, bool>::value) {
+            out += arg ? "true" : "false";
+        } else if constexpr (std::is_same<T, char>::value) {
+            out += arg;
+        } else if constexpr (std::is_arithmetic<T>::value) {
+            out += std::to_string(arg);
+        } else {
             std::ostringstream oss;
-            oss << "[" << buf << "." << std::setfill('0') << std::setw(3) << ms << "] [" << level << "] "
-                << "[" << file << ":" << function << ":" << line << "] "
-                << message << std::endl;
-            logFile << oss.str();
+            oss << arg;
+            out += oss.str();
+        }
+    }
+
+    struct Record {
+        int64_t stamp = 0;    // microseconds since epoch, used to merge threads in order
+        int level = LEVEL_INFO;
+        const char* file = "";
+        const char* function = "";
+        int line = 0;
+        uint32_t thread = 0;
+        std::string message;
+        std::unique_ptr<Deferred> deferred;    // formatted or encoded on the writer thread instead of message
+    };
+
+    // Owned by one producer thread and drained by the writer; head and tail only ever grow
+    struct ThreadBuffer {
+        std::array<Record, RING_SLOTS> slots;
+        std::atomic<size_t> head{0};
+        std::atomic<size_t> tail{0};
+        std::atomic<size_t> dropped{0};
+        std::atomic<bool> orphaned{false};    // producer thread has exited
+        uint32_t index = 0;    // small thread id for the event log
+    };
+
+    struct State {
+        int fd = -1;
+        std::atomic<bool> running{false};
+        std::atomic<size_t> dropped_total{0};
+        std::mutex registry_mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        std::mutex drain_mutex;
+        std::mutex wake_mutex;
+        std::condition_variable wake;
+        std::thread writer;
+        std::vector<Record> pending;
+        std::string batch;
+        eventlog::Writer events;
+        uint32_t next_thread = 0;
+    };
+
+    static std::mutex& levelsMutex() {
+        static std::mutex m;
+        return m;
+    }
+
+    static int& defaultLevel() {
+        static int level = LEVEL_INFO;
+        return level;
+    }
+
+    static std::map<std::string, int>& moduleLevels() {
+        static std::map<std::string, int> levels;
+        return levels;
+    }
+
+    static std::atomic<uint32_t>& levelsGeneration() {
+        static std::atomic<uint32_t> generation{1};
+        return generation;
+    }
+
+    static int moduleLevel(const char* file) {
+        std::string module = file;
+        size_t slash = module.find_last_of('/');
+        if (slash != std::string::npos)
+            module.erase(0, slash + 1);
+        size_t dot = module.find('.');
+        if (dot != std::string::npos)
+            module.resize(dot);
+        std::lock_guard<std::mutex> lock(levelsMutex());
+        auto it = moduleLevels().find(module);
+        return it != moduleLevels().end() ? it->second : defaultLevel();
+    }
+
+    struct LocalHandle {
+        std::shared_ptr<ThreadBuffer> buffer = std::make_shared<ThreadBuffer>();
+        ~LocalHandle() {
+            buffer->orphaned.store(true, std::memory_order_release);
+        }
+    };
+
+    // Never destroyed, so threads and static destructors can still log during shutdown
+    static State& state() {
+        static State* s = start();
+        return *s;
+    }
+
+    static State* start() {
+        State* s = new State();
+        s->fd = ::open(LOG_PATH, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        s->running = true;
+        s->writer = std::thread(writeLoop, s);
+        std::atexit(shutdown);
+        for (int sig : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+            struct sigaction current;
+            // Leave handlers someone else installed alone
+            if (sigaction(sig, nullptr, &current) == 0 && current.sa_handler == SIG_DFL)
+                std::signal(sig, onFatalSignal);
+        }
+        return s;
+    }
+
+    static ThreadBuffer& localBuffer() {
+        thread_local LocalHandle handle;
+        thread_local bool registered = false;
+        if (!registered) {
+            State& s = state();
+            std::lock_guard<std::mutex> lock(s.registry_mutex);
+            handle.buffer->index = s.next_thread++;
+            s.buffers.push_back(handle.buffer);
+            registered = true;
+        }
+        return *handle.buffer;
+    }
+
+    static int64_t nowMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    static const char* levelName(int level) {
+        static const char* names[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+        return names[std::min(std::max(level, 0), 3)];
+    }
+
+    static Record makeRecord(int level, const char* file, const char* function, int line) {
+        Record record;
+        record.stamp = nowMicros();
+        record.level = level;
+        record.file = file;
+        record.function = function;
+        record.line = line;
+        return record;
+    }
+
+    static void log(int level, const std::string &message, const char* file, const char* function, int line) {
+        Record record = makeRecord(level, file, function, line);
+        record.message = message;
+        enqueue(std::move(record));
+    }
+
+    // FOLOG.log line
+    static void render(Record& record, std::string& out) {
+        out += '[';
+        out += timestamp(record.stamp);
+        out += "] [";
+        out += levelName(record.level);
+        out += "] [";
+        out += record.file;
+        out += ':';
+        out += record.function;
+        out += ':';
+        out += std::to_string(record.line);
+        out += "] ";
+        if (record.deferred) {
+            try {
+                out += record.deferred->format();
+            } catch (const std::exception& e) {
+                out += "<format error: " + std::string(e.what()) + ">";
+            }
+        } else {
+            out += record.message;
+        }
+        out += '\n';
+    }
+
+    static void encode(Record& record, eventlog::Writer& events) {
+        events.begin(record.file, record.function, record.line, record.level, record.deferred ? record.deferred->pattern() : "{}", record.stamp, record.thread);
+        if (record.deferred)
+            record.deferred->encode(events);
+        else
+            events.field(record.message);
+        events.end();
+    }
+
+    static void enqueue(Record&& record) {
+        State& s = state();
+        bool urgent = record.level >= LEVEL_ERROR;
+        if (!s.running.load(std::memory_order_acquire)) {
+            // After shutdown write straight through as text
+            std::lock_guard<std::mutex> lock(s.drain_mutex);
+            std::string text;
+            render(record, text);
+            writeAll(s.fd, text.data(), text.size());
+            return;
+        }
+        ThreadBuffer& buffer = localBuffer();
+        record.thread = buffer.index;
+        size_t head = buffer.head.load(std::memory_order_relaxed);
+        size_t used = head - buffer.tail.load(std::memory_order_acquire);
+        if (used >= RING_SLOTS) {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            s.wake.notify_one();
+            return;
+        }
+        buffer.slots[head % RING_SLOTS] = std::move(record);
+        buffer.head.store(head + 1, std::memory_order_release);
+        // Errors and filling rings are written now rather than at the next interval
+        if (urgent || used >= RING_SLOTS / 2)
+            s.wake.notify_one();
+    }
+
+    // "YYYY-mm-dd HH:MM:SS.mmm"; the part up to the seconds is formatted once per second per thread
+    static std::string timestamp(int64_t us) {
+        thread_local std::time_t cached_second = -1;
+        thread_local char cached[32];
+        std::time_t second = static_cast<std::time_t>(us / 1000000);
+        if (second != cached_second) {
+            std::tm local_tm;
+            localtime_r(&second, &local_tm);
+            std::strftime(cached, sizeof(cached), "%Y-%m-%d %H:%M:%S", &local_tm);
+            cached_second = second;
+        }
+        char ms[8];
+        std::snprintf(ms, sizeof(ms), ".%03d", static_cast<int>((us / 1000) % 1000));
+        return std::string(cached) + ms;
+    }
+
+    static void writeLoop(State* s) {
+        while (s->running.load(std::memory_order_acquire)) {
+            {
+                std::unique_lock<std::mutex> lock(s->wake_mutex);
+                s->wake.wait_for(lock, FLUSH_INTERVAL);
+            }
+            drainAll(*s);
+        }
+    }
+
+    static void drainAll(State& s) {
+        std::lock_guard<std::mutex> drain_lock(s.drain_mutex);
+        size_t dropped_now = 0;
+        {
+            std::lock_guard<std::mutex> lock(s.registry_mutex);
+            for (auto& buffer : s.buffers) {
+                size_t tail = buffer->tail.load(std::memory_order_relaxed);
+                size_t head = buffer->head.load(std::memory_order_acquire);
+                for (; tail != head; ++tail)
+                    s.pending.push_back(std::move(buffer->slots[tail % RING_SLOTS]));
+                buffer->tail.store(tail, std::memory_order_release);
+                dropped_now += buffer->dropped.exchange(0, std::memory_order_relaxed);
+            }
+            // Forget rings of exited threads once they are empty
+            s.buffers.erase(std::remove_if(s.buffers.begin(), s.buffers.end(), [](const std::shared_ptr<ThreadBuffer>& buffer) {
+                return buffer->orphaned.load(std::memory_order_acquire) &&
+                       buffer->head.load(std::memory_order_acquire) == buffer->tail.load(std::memory_order_relaxed);
+            }), s.buffers.end());
+        }
+        if (s.pending.empty() && dropped_now == 0)
+            return;
+
+        std::stable_sort(s.pending.begin(), s.pending.end(), [](const Record& a, const Record& b) { return a.stamp < b.stamp; });
+        if (dropped_now > 0) {
+            s.dropped_total.fetch_add(dropped_now, std::memory_order_relaxed);
+            Record note = makeRecord(LEVEL_WARN, __FILE__, __FUNCTION__, __LINE__);
+            note.deferred.reset(new DeferredFormat<size_t>("{} log records dropped, ring full", dropped_now));
+            s.pending.push_back(std::move(note));
+        }
+        if (s.events.isOpen()) {
+            for (auto& record : s.pending)
+                encode(record, s.events);
+            s.events.flush();
+        } else {
+            s.batch.clear();
+            for (auto& record : s.pending)
+                render(record, s.batch);
+            writeAll(s.fd, s.batch.data(), s.batch.size());
+        }
+        s.pending.clear();
+    }
+
+    static void shutdown() {
+        State& s = state();
+        if (!s.running.exchange(false))
+            return;
+        s.wake.notify_one();
+        if (s.writer.joinable())
+            s.writer.join();
+        drainAll(s);
+        std::lock_guard<std::mutex> lock(s.drain_mutex);
+        s.events.close();
+    }
+
+    // Only async-signal-safe calls past this point: write whatever the rings hold, then die with the default action
+    static void onFatalSignal(int sig) {
+        State& s = state();
+        if (s.drain_mutex.try_lock()) {
+            if (s.registry_mutex.try_lock()) {
+                for (auto& buffer : s.buffers) {
+                    size_t head = buffer->head.load(std::memory_order_acquire);
+                    for (size_t tail = buffer->tail.load(std::memory_order_relaxed); tail != head; ++tail) {
+                        // Text without timestamp; formatting is not signal safe, so deferred records keep only their pattern
+                        const Record& record = buffer->slots[tail % RING_SLOTS];
+                        char line[16];
+                        int n = 0;
+                        for (int v = record.line; n == 0 || v > 0; v /= 10)
+                            line[n++] = static_cast<char>('0' + v % 10);
+                        std::reverse(line, line + n);
+                        writeText(s.fd, "[");
+                        writeText(s.fd, levelName(record.level));
+                        writeText(s.fd, "] [");
+                        writeText(s.fd, record.file);
+                        writeText(s.fd, ":");
+                        writeAll(s.fd, line, n);
+                        writeText(s.fd, "] ");
+                        if (record.deferred)
+                            writeText(s.fd, record.deferred->pattern());
+                        else
+                            writeAll(s.fd, record.message.data(), record.message.size());
+                        writeText(s.fd, "\n");
+                    }
+                    buffer->tail.store(head, std::memory_order_release);
+                }
+                s.registry_mutex.unlock();
+            }
+            s.drain_mutex.unlock();
+        }
+        const char* note = "[FATAL] [Logger] fatal signal, log flushed\n";
+        writeAll(s.fd, note, std::strlen(note));
+        ::fsync(s.fd);
+        std::signal(sig, SIG_DFL);
+        std::raise(sig);
+    }
+
+    static void writeText(int fd, const char* text) {
+        writeAll(fd, text, std::strlen(text));
+    }
+
+    static void writeAll(int fd, const char* data, size_t size) {
+        if (fd < 0)
+            return;
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                return;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
         }
     }
 };
 
-#define LOG_INFO(msg) Logger::logInfoImpl(msg, __FILE__, __FUNCTION__, __LINE__)
-#define LOG_ERROR(msg) Logger::logErrorImpl(msg, __FILE__, __FUNCTION__, __LINE__)
-#define LOG_WARN(msg) Logger::logWarnImpl(msg, __FILE__, __FUNCTION__, __LINE__)
+// Statements below this level are compiled out, e.g. DEFINES += LOG_COMPILE_LEVEL=1 drops LOG_DEBUG
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 0
+#endif
 
-#endif // LOGGER_H
+#define LOG_ENABLED(level) ((level) >= LOG_COMPILE_LEVEL && [] { static Logger::Site site(__FILE__); return &site; }()->enabled(level))
 
+#define LOG_DEBUG(msg) do { if (LOG_ENABLED(Logger::LEVEL_DEBUG)) Logger::logDebugImpl(msg, __FILE__, __FUNCTION__, __LINE__); } while (0)
+#define LOG_INFO(msg) do { if (LOG_ENABLED(Logger::LEVEL_INFO)) Logger::logInfoImpl(msg, __FILE__, __FUNCTION__, __LINE__); } while (0)
+#define LOG_ERROR(msg) do { if (LOG_ENABLED(Logger::LEVEL_ERROR)) Logger::logErrorImpl(msg, __FILE__, __FUNCTION__, __LINE__); } while (0)
+#define LOG_WARN(msg) do { if (LOG_ENABLED(Logger::LEVEL_WARN)) Logger::logWarnImpl(msg, __FILE__, __FUNCTION__, __LINE__); } while (0)
+
+#define LOG_DEBUGF(...) do { if (LOG_ENABLED(Logger::LEVEL_DEBUG)) Logger::logFormat(Logger::LEVEL_DEBUG, __FILE__, __FUNCTION__, __LINE__, __VA_ARGS__); } while (0)
+#define LOG_INFOF(...) do { if (LOG_ENABLED(Logger::LEVEL_INFO)) Logger::logFormat(Logger::LEVEL_INFO, __FILE__, __FUNCTION__, __LINE__, __VA_ARGS__); } while (0)
+#define LOG_WARNF(...) do { if (LOG_ENABLED(Logger::LEVEL_WARN)) Logger::logFormat(Logger::LEVEL_WARN, __FILE__, __FUNCTION__, __LINE__, __VA_ARGS__); } while (0)
+#define LOG_ERRORF(...) do { if (LOG_ENABLED(Logger::LEVEL_ERROR)) Logger::logFormat(Logger::LEVEL_ERROR, __FILE__, __FUNCTION__, __LINE__, __VA_ARGS__); } while (0)
+
+#endif // LOGGER_H
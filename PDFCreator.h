@@ -1,6 +1,11 @@
 #include <iostream>
 #include <string>
+#include <vector>
+#include <unordered_map>
 #include <hpdf.h>
+#include <QImage>
+#include <QBuffer>
+#include <QByteArray>
 #include <stdexcept>
 #include "Logger.h"
 
@@ -17,7 +22,12 @@ private:
     bool m_textBlockActive;
     int m_pageCount;    // Track total pages
     int m_lineCount;    // Track total lines of text
-    size_t lastSpacePos = 0;
+    // Advance widths per codepoint in 1/1000 em of m_font, measured once per font
+    std::unordered_map<uint32_t, HPDF_INT> m_glyphWidths;
+    // Wrapped lines of recently added strings; the same status lines are logged over and over
+    std::unordered_map<std::string, std::vector<std::string>> m_wrapCache;
+    static constexpr size_t WRAP_CACHE_ENTRIES = 512;
+    static constexpr int MAX_IMAGE_WIDTH = 640;
 
     void createNewPage() {
         if (m_textBlockActive) {
@@ -48,6 +58,75 @@ private:
         }
     }
 
+    HPDF_INT glyphWidth(uint32_t codepoint) {
+        auto it = m_glyphWidths.find(codepoint);
+        if (it != m_glyphWidths.end())
+            return it->second;
+        HPDF_INT width = HPDF_Font_GetUnicodeWidth(m_font, static_cast<HPDF_UNICODE>(codepoint));
+        m_glyphWidths.emplace(codepoint, width);
+        return width;
+    }
+
+    // Decode one UTF-8 sequence at pos, advancing pos. Malformed bytes decode as themselves.
+    static uint32_t nextCodepoint(const std::string& text, size_t& pos) {
+        unsigned char c = static_cast<unsigned char>(text[pos++]);
+        int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : 0;
+        uint32_t codepoint = extra == 3 ? (c & 0x07) : extra == 2 ? (c & 0x0F) : extra == 1 ? (c & 0x1F) : c;
+        for (; extra > 0 && pos < text.size(); --extra) {
+            unsigned char next = static_cast<unsigned char>(text[pos]);
+            if ((next & 0xC0) != 0x80)
+                break;
+            codepoint = (codepoint << 6) | (next & 0x3F);
+            ++pos;
+        }
+        return codepoint;
+    }
+
+    // Split text into lines no wider than maxLineWidth in one pass, breaking after the last space when possible
+    // and never inside a UTF-8 sequence. Results are memoized per string.
+    const std::vector<std::string>& wrapText(const std::string& text, float maxLineWidth) {
+        auto cached = m_wrapCache.find(text);
+        if (cached != m_wrapCache.end())
+            return cached->second;
+        if (m_wrapCache.size() >= WRAP_CACHE_ENTRIES)
+            m_wrapCache.clear();
+
+        std::vector<std::string> lines;
+        // Widths are summed in font units and compared against the limit scaled to the same units
+        const double limit = maxLineWidth * 1000.0 / m_fontSize;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            // Trim leading whitespace of continuation lines
+            if (!lines.empty()) {
+                while (pos < text.size() && text[pos] == ' ')
+                    ++pos;
+                if (pos >= text.size())
+                    break;
+            }
+            size_t lineStart = pos;
+            size_t lineEnd = text.size();
+            size_t lastSpace = std::string::npos;
+            double width = 0;
+            while (pos < text.size()) {
+                size_t charStart = pos;
+                uint32_t codepoint = nextCodepoint(text, pos);
+                HPDF_INT advance = glyphWidth(codepoint);
+                // A line always takes at least one character, even one wider than the limit
+                if (width + advance > limit && charStart > lineStart) {
+                    // Back up to the last space if possible; only the word after it is measured again
+                    lineEnd = (lastSpace != std::string::npos) ? lastSpace : charStart;
+                    pos = (lastSpace != std::string::npos) ? lastSpace + 1 : charStart;
+                    break;
+                }
+                width += advance;
+                if (codepoint == ' ')
+                    lastSpace = charStart;
+            }
+            lines.push_back(text.substr(lineStart, lineEnd - lineStart));
+        }
+        return m_wrapCache.emplace(text, std::move(lines)).first->second;
+    }
+
     void ensureSpaceForImage(float imageHeight) {
         float requiredSpace = imageHeight + 10; // Add small margin
         while (m_currentY - requiredSpace < m_bottomMargin) {
@@ -55,6 +134,26 @@ private:
         }
     }
 
+    void drawImage(HPDF_Image image) {
+        float imageHeight = HPDF_Image_GetHeight(image);
+        float imageWidth = HPDF_Image_GetWidth(image);
+        float maxWidth = HPDF_Page_GetWidth(m_currentPage) - 100;
+        float scale = (imageWidth > maxWidth) ? (maxWidth / imageWidth) : 1.0f;
+
+        ensureSpaceForImage(imageHeight * scale);
+        if (m_textBlockActive) {
+            HPDF_Page_EndText(m_currentPage);
+            m_textBlockActive = false;
+        }
+
+        HPDF_Page_DrawImage(m_currentPage, image,
+            50, m_currentY - (imageHeight * scale),
+            imageWidth * scale, imageHeight * scale
+        );
+
+        m_currentY -= (imageHeight * scale + 10);
+    }
+
 public:
     PDFCreator() 
         : m_pdf(HPDF_New(error_handler, nullptr)),
@@ -90,53 +189,9 @@ public:
         const float pageWidth = HPDF_Page_GetWidth(m_currentPage) - 100; // 50px margins on both sides
         const float maxLineWidth = pageWidth - 50; // Additional safety margin
 
-        std::string remainingText = text;
-        
-        while (!remainingText.empty()) {
+        const std::vector<std::string>& lines = wrapText(text, maxLineWidth);
+        for (const std::string& line : lines) {
             ensureSpaceForText(); // Check if we need a new page
-            
-            // Measure how much text fits in one line
-            HPDF_REAL width = 0;
-            size_t charsThatFit = 0;
-            bool foundSpace = false;
-            
-            // Find the maximum number of characters that fit
-            for (size_t i = 1; i <= remainingText.length(); ++i) {
-                std::string testStr = remainingText.substr(0, i);
-                width = HPDF_Page_TextWidth(m_currentPage, testStr.c_str());
-                
-                if (width > maxLineWidth) {
-                    // If we exceeded width, back up to last space if possible
-                    if (foundSpace) {
-                        charsThatFit = lastSpacePos;
-                    } else {
-                        // If no space found, just break at current position
-                        charsThatFit = i - 1;
-                    }
-                    break;
-                }
-                
-                // Remember last space position for word wrapping
-                if (remainingText[i-1] == ' ') {
-                    lastSpacePos = i;
-                    foundSpace = true;
-                }
-                
-                // If we reached end of string
-                if (i == remainingText.length()) {
-                    charsThatFit = i;
-                }
-            }
-
-            // Extract the portion that fits
-            std::string line = remainingText.substr(0, charsThatFit);
-            remainingText = remainingText.substr(charsThatFit);
-            
-            // Trim leading whitespace from remaining text
-            while (!remainingText.empty() && remainingText[0] == ' ') {
-                remainingText.erase(0, 1);
-            }
-
             // Output the line
             HPDF_Page_TextOut(m_currentPage, 50, m_currentY, line.c_str());
             m_currentY -= m_lineSpacing;
@@ -158,6 +213,8 @@ public:
         m_pageCount = 0;
         m_lineCount = 0;
         m_textBlockActive = false;
+        m_glyphWidths.clear();
+        m_wrapCache.clear();
         
         // Create a new PDF document
         m_pdf = HPDF_New(error_handler, nullptr);
@@ -185,49 +242,69 @@ public:
     }
 
     void addImage(const std::string& imagePath) {
-        if (m_textBlockActive) {
-            HPDF_Page_EndText(m_currentPage);
-            m_textBlockActive = false;
-        }
-
-        // Load image using Qt to resize/compress
         QImage img(QString::fromStdString(imagePath));
         if (img.isNull()) {
             LOG_ERROR("Failed to load image: " + imagePath);
             throw std::runtime_error("Invalid image: " + imagePath);
         }
+        addImage(img);
+    }
 
-        // Resize to max 800px width (adjust as needed)
-        img = img.scaledToWidth(640, Qt::SmoothTransformation);
-
-        // Save as JPEG (quality 80) to a temp file
-        QString tempPath = QString::fromStdString(imagePath) + "_compressed.jpg";
-        if (!img.save(tempPath, "JPEG", 80)) {
+    // Downscale to at most MAX_IMAGE_WIDTH and encode to JPEG in memory
+    static QByteArray encodeJpeg(const QImage& source) {
+        if (source.isNull()) {
+            LOG_ERROR("Failed to add empty image");
+            throw std::runtime_error("Invalid image");
+        }
+        QImage img = source.width() > MAX_IMAGE_WIDTH ? source.scaledToWidth(MAX_IMAGE_WIDTH, Qt::SmoothTransformation) : source;
+        QByteArray jpeg;
+        QBuffer buffer(&jpeg);
+        buffer.open(QIODevice::WriteOnly);
+        if (!img.save(&buffer, "JPEG", 80)) {
             LOG_ERROR("Failed to compress image");
             throw std::runtime_error("Image compression failed");
         }
+        return jpeg;
+    }
+
+    void addImage(const QImage& source) {
+        QByteArray jpeg = encodeJpeg(source);
+        addJpeg(reinterpret_cast<const unsigned char*>(jpeg.constData()), static_cast<size_t>(jpeg.size()));
+    }
 
-        // Load the compressed image into PDF
-        HPDF_Image image = HPDF_LoadJpegImageFromFile(m_pdf, tempPath.toStdString().c_str());
+    // Embed an already encoded JPEG without touching the filesystem. The returned handle can be drawn again with
+    // addImageAgain until reset().
+    HPDF_Image addJpeg(const unsigned char* data, size_t size) {
+        if (m_textBlockActive) {
+            HPDF_Page_EndText(m_currentPage);
+            m_textBlockActive = false;
+        }
+
+        HPDF_Image image = HPDF_LoadJpegImageFromMem(m_pdf, data, static_cast<HPDF_UINT>(size));
         if (!image) {
             LOG_ERROR("Failed to load compressed image");
             throw std::runtime_error("PDF image load failed");
         }
+        drawImage(image);
+        return image;
+    }
 
-        // Proceed with original scaling/placement logic
-        float imageHeight = HPDF_Image_GetHeight(image);
-        float imageWidth = HPDF_Image_GetWidth(image);
-        float maxWidth = HPDF_Page_GetWidth(m_currentPage) - 100;
-        float scale = (imageWidth > maxWidth) ? (maxWidth / imageWidth) : 1.0f;
-        
-        HPDF_Page_DrawImage(m_currentPage, image,
-            50, m_currentY - (imageHeight * scale),
-            imageWidth * scale, imageHeight * scale
-        );
-        
-        m_currentY -= (imageHeight * scale + 10);
-        QFile::remove(tempPath); // Clean up temp file
+    // Continue on a new page, unless nothing was drawn on the current one yet
+    void addPageBreak() {
+        if (m_currentPage && m_currentY >= HPDF_Page_GetHeight(m_currentPage) - m_topMargin)
+            return;
+        createNewPage();
     }
+
+    // Draw an image embedded in this document again; the PDF references the same image object instead of a copy
+    void addImageAgain(HPDF_Image image) {
+        if (m_textBlockActive) {
+            HPDF_Page_EndText(m_currentPage);
+            m_textBlockActive = false;
+        }
+        drawImage(image);
+    }
+
     void addImage1(const std::string& imagePath) {
         if (m_textBlockActive) {
             HPDF_Page_EndText(m_currentPage);
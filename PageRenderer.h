@@ -0,0 +1,432 @@
+#ifndef PAGERENDERER_H
+#define PAGERENDERER_H
+
+#include <poppler-qt5.h>
+#include <QImage>
+#include <QRect>
+#include <QSizeF>
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <list>
+#include <deque>
+#include <map>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#include "Logger.h"
+#include "DiskPageCache.h"
+
+// Renders PDF pages, or tiles of them, on a small pool of worker threads into an LRU cache bounded by a memory budget.
+// Every worker loads and owns its own Poppler::Document, so a document is never shared between threads and open()
+// never parses or waits for a render on the caller's thread. Each open() starts a new generation; results carry it so
+// the caller can drop renders of a previous document that were already on their way.
+// With a DiskPageCache attached, full pages are keyed by content hash and also read from / written to disk. A document
+// whose hash is not memoized yet is hashed by a worker; until then its pages are keyed by path and skip the disk.
+class PageRenderer {
+public:
+    // region is empty for a full page, otherwise the tile rectangle in page pixels at zoom; generation is that of the
+    // open() the render belongs to, compare it with generation()
+    using RenderedCallback = std::function<void(uint64_t generation, int page, float zoom, const QRect& region, const QImage& image)>;
+
+    static constexpr int TILE_SIZE = 256;
+    static constexpr float PREVIEW_ZOOM = 1.0f;
+    // Zoom a document opens at, and the one the disk cache is warmed for
+    static constexpr float DEFAULT_ZOOM = 1.5f;
+    // Pages larger than this at the current zoom are rendered as tiles
+    static constexpr double TILE_MODE_PIXELS = 4.0 * 1024 * 1024;
+
+    explicit PageRenderer(size_t _budget_bytes = 64 * 1024 * 1024, int _threads = 2)
+        : budget_bytes(_budget_bytes), thread_count(std::max(1, _threads)) {}
+
+    ~PageRenderer() {
+        stop();
+    }
+
+    void setRenderedCallback(RenderedCallback callback) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        rendered_callback = std::move(callback);
+    }
+
+    void setDiskCache(DiskPageCache* cache) {
+        disk_cache = cache;
+    }
+
+    // Switch the workers to another document; each loads it on its next job. Cached pages of earlier documents stay
+    // until evicted.
+    bool open(const std::string& path) {
+        try {
+            // Hashing a large manual takes hundreds of ms, so only a memoized hash is used here
+            std::string hash = disk_cache ? disk_cache->knownHash(path) : "";
+            {
+                // Retire queued and in-flight jobs of the previous document
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                jobs.clear();
+                ++generation;
+                doc_path = path;
+                doc_hash = hash;
+                doc_key = hash.empty() ? path : hash;
+                if (disk_cache && hash.empty())
+                    jobs.push_front({-1, 0.0f, QRect(), generation, true});
+                if (workers.empty()) {
+                    for (int i = 0; i < thread_count; ++i)
+                        workers.push_back(std::make_unique<Worker>());
+                }
+                for (auto& worker : workers)
+                    worker->release = false;
+            }
+            queue_cv.notify_one();
+            if (!running) {
+                running = true;
+                for (auto& worker : workers)
+                    worker->thread = std::thread(&PageRenderer::RenderLoop, this, worker.get());
+            }
+            return true;
+        } catch (const std::exception& e) {
+            LOG_ERROR("PageRenderer open error: " + std::string(e.what()));
+            return false;
+        }
+    }
+
+    // Renders of the current document carry this generation
+    uint64_t currentGeneration() {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        return generation;
+    }
+
+    // The workers drop their documents once they finish what they are rendering
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            jobs.clear();
+            ++generation;
+            if (!doc_path.empty())
+                LOG_INFO("PageRenderer " + doc_path + ": hits " + std::to_string(hits) + ", misses " + std::to_string(misses) +
+                         ", disk hits " + std::to_string(disk_hits) +
+                         ", cached " + std::to_string(cache_bytes / 1024) + " KB");
+            doc_path.clear();
+            doc_key.clear();
+            doc_hash.clear();
+            hits = misses = disk_hits = 0;
+            for (auto& worker : workers)
+                worker->release = true;
+        }
+        queue_cv.notify_all();
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            running = false;
+            jobs.clear();
+        }
+        queue_cv.notify_all();
+        for (auto& worker : workers) {
+            if (worker->thread.joinable())
+                worker->thread.join();
+        }
+        close();
+        for (auto& worker : workers)
+            worker->document.reset();
+    }
+
+    // Cached render of page (or of one tile of it) at zoom, touching it as most recently used
+    bool cached(int page, float zoom, QImage& out, const QRect& region = QRect()) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        auto it = index.find(makeKey(doc_key, page, zoom, region));
+        if (it == index.end()) {
+            ++misses;
+            return false;
+        }
+        lru.splice(lru.begin(), lru, it->second);
+        out = it->second->image;
+        ++hits;
+        return true;
+    }
+
+    // Full page from the disk cache, promoted into memory. Decoding a PNG is much cheaper than a Poppler render.
+    bool cachedOnDisk(int page, float zoom, QImage& out) {
+        std::string hash, key;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            hash = doc_hash;
+            key = doc_key;
+        }
+        if (!disk_cache || hash.empty() || !disk_cache->load(hash, page, zoom, out))
+            return false;
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (key == doc_key)
+            insert(makeKey(key, page, zoom, QRect()), out);
+        ++disk_hits;
+        return true;
+    }
+
+    // Render as soon as a worker is free, ahead of any prefetch
+    void request(int page, float zoom, const QRect& region = QRect()) {
+        enqueue(page, zoom, region, true);
+    }
+
+    void prefetch(int page, float zoom, const QRect& region = QRect()) {
+        enqueue(page, zoom, region, false);
+    }
+
+    // Drop queued tile jobs that were not started yet, e.g. when the view scrolled away from them
+    void cancelTiles() {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        for (auto it = jobs.begin(); it != jobs.end();) {
+            if (it->region.isEmpty())
+                ++it;
+            else
+                it = jobs.erase(it);
+        }
+    }
+
+    static bool needsTiles(Poppler::Page* page, float zoom) {
+        if (!page)
+            return false;
+        QSizeF points = page->pageSizeF();
+        return points.width() * zoom * points.height() * zoom > TILE_MODE_PIXELS;
+    }
+
+    // Quick low-DPI render of page, scaled up to the size of the full render so the layout does not jump
+    static QImage placeholder(Poppler::Page* page, float zoom) {
+        if (!page)
+            return QImage();
+        QImage low = page->renderToImage(PLACEHOLDER_DPI, PLACEHOLDER_DPI);
+        if (low.isNull())
+            return low;
+        QSizeF points = page->pageSizeF();
+        QSize full(static_cast<int>(points.width() * zoom), static_cast<int>(points.height() * zoom));
+        return low.scaled(full, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    }
+
+private:
+    static constexpr double PLACEHOLDER_DPI = 18.0;
+    using Key = std::tuple<std::string, int, int, int, int, int, int>;   // document, page, zoom in 1/1000, region
+
+    struct Entry {
+        Key key;
+        QImage image;
+        size_t bytes;
+    };
+
+    struct Job {
+        int page;
+        float zoom;
+        QRect region;
+        uint64_t generation;
+        bool hash_document = false;                        // compute doc_hash instead of rendering
+    };
+
+    struct Worker {
+        std::thread thread;
+        std::unique_ptr<Poppler::Document> document;      // worker thread only
+        uint64_t doc_generation = 0;                       // open() the document was loaded for
+        bool release = false;                              // drop the document, guarded by queue_mutex
+    };
+
+    size_t budget_bytes;
+    int thread_count;
+    size_t cache_bytes = 0;
+    std::list<Entry> lru;                                  // front is most recently used
+    std::map<Key, std::list<Entry>::iterator> index;
+    std::deque<Job> jobs;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::string doc_path;
+    std::string doc_key;                                   // content hash when known, else the path
+    std::string doc_hash;
+    DiskPageCache* disk_cache = nullptr;
+    uint64_t generation = 0;
+    uint64_t hits = 0, misses = 0, disk_hits = 0;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::atomic<bool> running{false};
+    RenderedCallback rendered_callback;
+
+    static Key makeKey(const std::string& path, int page, float zoom, const QRect& region) {
+        int zoom_milli = static_cast<int>(zoom * 1000.0f + 0.5f);
+        if (region.isEmpty())
+            return Key(path, page, zoom_milli, 0, 0, 0, 0);
+        return Key(path, page, zoom_milli, region.x(), region.y(), region.width(), region.height());
+    }
+
+    static bool sameJob(const Job& job, int page, float zoom, const QRect& region) {
+        return job.page == page && job.zoom == zoom && job.region.isEmpty() == region.isEmpty() &&
+               (region.isEmpty() || (job.region.x() == region.x() && job.region.y() == region.y()));
+    }
+
+    void enqueue(int page, float zoom, const QRect& region, bool urgent) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (doc_key.empty() || page < 0 || index.count(makeKey(doc_key, page, zoom, region)))
+                return;
+            for (auto it = jobs.begin(); it != jobs.end(); ++it) {
+                if (sameJob(*it, page, zoom, region)) {
+                    if (!urgent)
+                        return;
+                    jobs.erase(it);
+                    break;
+                }
+            }
+            if (urgent)
+                jobs.push_front({page, zoom, region, generation});
+            else
+                jobs.push_back({page, zoom, region, generation});
+        }
+        queue_cv.notify_one();
+    }
+
+    void insert(const Key& key, const QImage& image) {
+        size_t bytes = static_cast<size_t>(image.bytesPerLine()) * image.height();
+        auto it = index.find(key);
+        if (it != index.end()) {
+            cache_bytes -= it->second->bytes;
+            lru.erase(it->second);
+            index.erase(it);
+        }
+        lru.push_front({key, image, bytes});
+        index[key] = lru.begin();
+        cache_bytes += bytes;
+        // Always keep the newest image, even if it alone exceeds the budget
+        while (cache_bytes > budget_bytes && lru.size() > 1) {
+            cache_bytes -= lru.back().bytes;
+            index.erase(lru.back().key);
+            lru.pop_back();
+        }
+    }
+
+    // Pages rendered while the document was keyed by path move to the content hash key
+    void hashDocument(uint64_t job_generation) {
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (job_generation != generation)
+                return;
+            path = doc_path;
+        }
+        std::string hash = disk_cache->contentHash(path);
+        if (hash.empty())
+            return;
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (job_generation != generation || doc_key != path)
+            return;
+        for (auto it = lru.begin(); it != lru.end();) {
+            if (std::get<0>(it->key) != path) {
+                ++it;
+                continue;
+            }
+            index.erase(it->key);
+            std::get<0>(it->key) = hash;
+            if (index.count(it->key)) {
+                // Already cached from an earlier open of the same content
+                cache_bytes -= it->bytes;
+                it = lru.erase(it);
+                continue;
+            }
+            index[it->key] = it;
+            ++it;
+        }
+        doc_hash = hash;
+        doc_key = hash;
+    }
+
+    // Parse the current document on the worker's own thread, replacing the one of an earlier open()
+    bool loadDocument(Worker* worker, const std::string& path, uint64_t job_generation) {
+        worker->document.reset();
+        worker->doc_generation = 0;
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<Poppler::Document> doc(Poppler::Document::load(QString::fromStdString(path)));
+        if (!doc) {
+            LOG_ERROR("PageRenderer failed to load " + path);
+            return false;
+        }
+        doc->setRenderHint(Poppler::Document::Antialiasing);
+        doc->setRenderHint(Poppler::Document::TextAntialiasing);
+        worker->document = std::move(doc);
+        worker->doc_generation = job_generation;
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("PageRenderer worker loaded " + path + " in " + std::to_string(ms) + " ms");
+        return true;
+    }
+
+    void RenderLoop(Worker* worker) {
+        while (true) {
+            Job job;
+            bool release;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cv.wait(lock, [this, worker] { return !running || !jobs.empty() || worker->release; });
+                if (!running)
+                    return;
+                release = worker->release;
+                worker->release = false;
+                if (!release) {
+                    job = jobs.front();
+                    jobs.pop_front();
+                }
+            }
+            try {
+                if (release) {
+                    worker->document.reset();
+                    worker->doc_generation = 0;
+                    continue;
+                }
+                if (job.hash_document) {
+                    hashDocument(job.generation);
+                    continue;
+                }
+                std::string key, hash, path;
+                {
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    if (job.generation != generation || index.count(makeKey(doc_key, job.page, job.zoom, job.region)))
+                        continue;
+                    key = doc_key;
+                    hash = doc_hash;
+                    path = doc_path;
+                }
+                if (worker->doc_generation != job.generation && !loadDocument(worker, path, job.generation))
+                    continue;
+                if (job.page >= worker->document->numPages())
+                    continue;
+                bool use_disk = disk_cache && !hash.empty() && job.region.isEmpty();
+                QImage image;
+                if (!use_disk || !disk_cache->load(hash, job.page, job.zoom, image)) {
+                    std::unique_ptr<Poppler::Page> page(worker->document->page(job.page));
+                    if (!page)
+                        continue;
+                    auto start = std::chrono::steady_clock::now();
+                    image = job.region.isEmpty()
+                        ? page->renderToImage(job.zoom * 72.0, job.zoom * 72.0)
+                        : page->renderToImage(job.zoom * 72.0, job.zoom * 72.0, job.region.x(), job.region.y(), job.region.width(), job.region.height());
+                    if (image.isNull()) {
+                        LOG_WARN("PageRenderer failed to render page " + std::to_string(job.page));
+                        continue;
+                    }
+                    if (job.region.isEmpty()) {
+                        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                        LOG_INFO("PageRenderer page " + std::to_string(job.page) + " rendered in " + std::to_string(ms) + " ms");
+                    }
+                    if (use_disk)
+                        disk_cache->store(hash, job.page, job.zoom, image);
+                }
+                RenderedCallback callback;
+                {
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    insert(makeKey(key, job.page, job.zoom, job.region), image);
+                    callback = rendered_callback;
+                }
+                if (callback)
+                    callback(job.generation, job.page, job.zoom, job.region, image);
+            } catch (const std::exception& e) {
+                LOG_ERROR("PageRenderer render error: " + std::string(e.what()));
+            }
+        }
+    }
+};
+
+#endif // PAGERENDERER_H
@@ -0,0 +1,209 @@
+#ifndef REPORTJOURNAL_H
+#define REPORTJOURNAL_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <filesystem>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "Logger.h"
+
+// Append-only journal of Standalone report events. Each record is
+// [u32 payload size][u8 type][u32 crc32 of type + payload][payload], fsync'd in batches.
+// Replay stops at the first torn or corrupt record, so a crash loses at most the last unsynced batch.
+class ReportJournal {
+public:
+    // Jpeg is a screen grab, CameraJpeg a camera frame. Repeat draws the previous image of the source in its one-byte
+    // payload again (no payload: the screen).
+    enum RecordType : uint8_t { Text = 1, Jpeg = 2, Saved = 3, Repeat = 4, PageBreak = 5, CameraJpeg = 6 };
+    enum ImageSource : uint8_t { Screen = 0, Camera = 1 };
+
+    explicit ReportJournal(const std::string& _path) : path(_path) {}
+
+    ~ReportJournal() {
+        close();
+    }
+
+    ReportJournal(const ReportJournal&) = delete;
+    ReportJournal& operator=(const ReportJournal&) = delete;
+
+    bool open() {
+        if (fd >= 0)
+            return true;
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        // Drop a torn tail left by a crash so new records stay reachable
+        uint64_t valid = scan(nullptr);
+        if (std::filesystem::exists(path, ec) && std::filesystem::file_size(path, ec) > valid) {
+            LOG_WARN("ReportJournal dropping torn tail after " + std::to_string(valid) + " bytes");
+            std::filesystem::resize_file(path, valid, ec);
+        }
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            LOG_ERROR("ReportJournal can't open " + path + ": " + std::string(strerror(errno)));
+            return false;
+        }
+        off_t end = ::lseek(fd, 0, SEEK_END);
+        bytes_written = end > 0 ? static_cast<uint64_t>(end) : 0;
+        last_sync = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void close() {
+        if (fd < 0)
+            return;
+        sync();
+        ::close(fd);
+        fd = -1;
+    }
+
+    bool append(RecordType type, const void* data, uint32_t size) {
+        if (!open())
+            return false;
+        unsigned char header[HEADER_SIZE];
+        std::memcpy(header, &size, 4);
+        header[4] = type;
+        uint32_t crc = crc32(0L, &header[4], 1);
+        if (size > 0)
+            crc = crc32(crc, static_cast<const Bytef*>(data), size);
+        std::memcpy(header + 5, &crc, 4);
+        if (!writeAll(header, HEADER_SIZE) || !writeAll(data, size)) {
+            LOG_ERROR("ReportJournal write failed: " + std::string(strerror(errno)));
+            return false;
+        }
+        ++unsynced;
+        bytes_written += HEADER_SIZE + size;
+        // Batch fsyncs: a few records or a couple of seconds, whichever comes first
+        if (unsynced >= SYNC_RECORDS || std::chrono::steady_clock::now() - last_sync >= SYNC_INTERVAL)
+            sync();
+        return true;
+    }
+
+    bool append(RecordType type, const std::string& text) {
+        return append(type, text.data(), static_cast<uint32_t>(text.size()));
+    }
+
+    void sync() {
+        if (fd < 0 || unsynced == 0)
+            return;
+        ::fdatasync(fd);
+        unsynced = 0;
+        last_sync = std::chrono::steady_clock::now();
+    }
+
+    // Start a new session
+    void truncate() {
+        close();
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0)
+            LOG_ERROR("ReportJournal can't truncate " + path + ": " + std::string(strerror(errno)));
+        else
+            ::fsync(fd);
+        last_sync = std::chrono::steady_clock::now();
+        bytes_written = 0;
+    }
+
+    // Visit every intact record in order, one payload in memory at a time. Returns the type of the last record.
+    RecordType replay(const std::function<void(RecordType, const std::vector<char>&)>& visit) {
+        sync();
+        RecordType last = Saved;
+        size_t records = 0;
+        scan([&](RecordType type, const std::vector<char>& payload) {
+            last = type;
+            ++records;
+            visit(type, payload);
+        });
+        LOG_INFO("ReportJournal replayed " + std::to_string(records) + " records");
+        return last;
+    }
+
+    // True if the journal holds events that never reached a saved report, e.g. after a crash
+    bool needsRecovery() {
+        bool has_records = false;
+        RecordType last = replay([&has_records](RecordType, const std::vector<char>&) { has_records = true; });
+        return has_records && last != Saved;
+    }
+
+    // Current journal size
+    uint64_t bytesWritten() const {
+        return bytes_written;
+    }
+
+private:
+    static constexpr size_t HEADER_SIZE = 9;
+    static constexpr uint32_t MAX_RECORD = 16 * 1024 * 1024;
+    static constexpr int SYNC_RECORDS = 16;
+    static constexpr std::chrono::seconds SYNC_INTERVAL{2};
+    std::string path;
+    int fd = -1;
+    int unsynced = 0;
+    uint64_t bytes_written = 0;
+    std::chrono::steady_clock::time_point last_sync;
+
+    // Walk the intact records, returning the offset just past the last one
+    uint64_t scan(const std::function<void(RecordType, const std::vector<char>&)>& visit) {
+        uint64_t valid = 0;
+        int in = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0)
+            return valid;
+        std::vector<char> payload;
+        unsigned char header[HEADER_SIZE];
+        while (readAll(in, header, HEADER_SIZE)) {
+            uint32_t size, crc;
+            std::memcpy(&size, header, 4);
+            std::memcpy(&crc, header + 5, 4);
+            RecordType type = static_cast<RecordType>(header[4]);
+            if (size > MAX_RECORD || type < Text || type > CameraJpeg)
+                break;
+            payload.resize(size);
+            if (!readAll(in, payload.data(), size))
+                break;
+            uint32_t check = crc32(0L, &header[4], 1);
+            if (size > 0)
+                check = crc32(check, reinterpret_cast<const Bytef*>(payload.data()), size);
+            if (check != crc)
+                break;
+            valid += HEADER_SIZE + size;
+            if (visit)
+                visit(type, payload);
+        }
+        ::close(in);
+        return valid;
+    }
+
+    bool writeAll(const void* data, size_t size) {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t n = ::write(fd, p, size);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    static bool readAll(int in, void* data, size_t size) {
+        char* p = static_cast<char*>(data);
+        while (size > 0) {
+            ssize_t n = ::read(in, p, size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+};
+
+#endif // REPORTJOURNAL_H
@@ -0,0 +1,375 @@
+#ifndef REPORTWRITER_H
+#define REPORTWRITER_H
+
+#include <string>
+#include <array>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <QImage>
+#undef Status
+#include <opencv2/opencv.hpp>
+#include "Logger.h"
+#include "PDFCreator.h"
+#include "ReportJournal.h"
+
+// Records the Standalone session report on its own thread. Callers only enqueue typed events; JPEG encoding happens
+// on the writer thread and every event is appended to an on-disk ReportJournal, so memory does not grow with the
+// session. The PDF is assembled from the journal on save, in volumes of bounded size, or on the next start after a
+// crash. The queue is bounded: when it is full the caller waits for the writer (backpressure) instead of growing memory.
+// Everything queued is written before destruction. Images whose dHash is within DEDUP_DISTANCE bits of the last
+// embedded image from the same source (screen grab or camera frame) are journalled as a reference to it instead of
+// being encoded and stored again. Screen grabs are only compared within one view (see setView), since a coarse hash of
+// the whole UI barely changes between two text pages.
+class ReportWriter {
+public:
+    explicit ReportWriter(const std::string& journal_path, size_t _capacity = 64) : journal(journal_path), capacity(_capacity), stopping(false) {
+        LOG_INFO("ReportWriter Constructor");
+        writer = std::thread([this]() { WriteLoop(); });
+    }
+
+    ~ReportWriter() {
+        stop();
+    }
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    void addText(const std::string& text) {
+        Event event;
+        event.type = Event::Text;
+        event.text = text;
+        push(std::move(event));
+    }
+
+    // Screen grab; downscaled and encoded on the writer thread
+    void addImage(const QImage& image) {
+        Event event;
+        event.type = Event::Image;
+        event.image = image;
+        push(std::move(event));
+    }
+
+    // BGR camera frame; encoded on the writer thread
+    void addImage(const cv::Mat& frame) {
+        Event event;
+        event.type = Event::Frame;
+        event.frame = frame.clone();
+        push(std::move(event));
+    }
+
+    // Following entries start on a new report page, e.g. when another document is opened
+    void addPageBreak() {
+        Event event;
+        event.type = Event::PageBreak;
+        push(std::move(event));
+    }
+
+    // What the screen shows, e.g. a document page or a task. The first screen grab of a different view is always
+    // embedded; later ones are deduplicated against it.
+    void setView(const std::string& view) {
+        Event event;
+        event.type = Event::View;
+        event.text = view;
+        push(std::move(event));
+    }
+
+    // Assemble the journal into filename if the report has at least min_pages pages
+    void save(const std::string& filename, int min_pages = 0) {
+        Event event;
+        event.type = Event::Save;
+        event.text = filename;
+        event.min_pages = min_pages;
+        push(std::move(event));
+    }
+
+    void reset() {
+        Event event;
+        event.type = Event::Reset;
+        push(std::move(event));
+    }
+
+    // Assemble a journal left over by a previous run that never saved into filename, then start a new journal
+    void recover(const std::string& filename) {
+        Event event;
+        event.type = Event::Recover;
+        event.text = filename;
+        push(std::move(event));
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (stopping)
+                return;
+            stopping = true;
+        }
+        queue_cv.notify_all();
+        if (writer.joinable())
+            writer.join();
+        LOG_INFO("ReportWriter stopped, " + std::to_string(written) + " events written, " + std::to_string(stalls) + " producer stalls, " + std::to_string(duplicates) + "/" + std::to_string(images) + " images deduplicated");
+    }
+
+    // Fraction of report images replaced by a reference to the previous one
+    double dedupRatio() const {
+        size_t total = images;
+        return total ? static_cast<double>(duplicates) / total : 0.0;
+    }
+
+private:
+    struct Event {
+        enum Type { Text, Image, Frame, PageBreak, View, Save, Reset, Recover } type = Text;
+        std::string text;
+        QImage image;
+        cv::Mat frame;
+        int min_pages = 0;
+    };
+
+    // Image bytes per assembled PDF; libharu keeps a whole document in memory until it is written
+    static constexpr size_t VOLUME_IMAGE_BYTES = 48 * 1024 * 1024;
+    // Max differing bits of the 64-bit dHash for two images to count as the same view
+    static constexpr int DEDUP_DISTANCE = 5;
+    ReportJournal journal;
+    PDFCreator pdf;
+    size_t capacity;
+    std::deque<Event> events;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;      // writer waits for events
+    std::condition_variable space_cv;      // producers wait for room
+    std::thread writer;
+    bool stopping;
+    std::atomic<size_t> written{0};
+    size_t stalls = 0;
+    // dHash of the last embedded image per ReportJournal::ImageSource, writer thread only
+    std::array<uint64_t, 2> last_hash = {};
+    std::array<bool, 2> have_last_hash = {};
+    std::string view;    // last setView(), writer thread only
+    std::atomic<size_t> images{0};
+    std::atomic<size_t> duplicates{0};
+
+    void push(Event&& event) {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        if (stopping) {
+            LOG_WARN("ReportWriter dropping event after stop");
+            return;
+        }
+        if (events.size() >= capacity) {
+            auto start = std::chrono::steady_clock::now();
+            space_cv.wait(lock, [this] { return events.size() < capacity || stopping; });
+            ++stalls;
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            LOG_WARN("ReportWriter queue full, caller waited " + std::to_string(ms) + " ms");
+        }
+        if (stopping)
+            return;
+        events.push_back(std::move(event));
+        lock.unlock();
+        queue_cv.notify_one();
+    }
+
+    void process(Event& event) {
+        switch (event.type) {
+            case Event::Text:
+                journal.append(ReportJournal::Text, event.text);
+                break;
+            case Event::Image: {
+                if (event.image.isNull())
+                    break;
+                if (isDuplicate(ReportJournal::Screen, dHash(event.image))) {
+                    appendRepeat(ReportJournal::Screen);
+                    break;
+                }
+                QByteArray jpeg = PDFCreator::encodeJpeg(event.image);
+                journal.append(ReportJournal::Jpeg, jpeg.constData(), static_cast<uint32_t>(jpeg.size()));
+                break;
+            }
+            case Event::Frame: {
+                if (event.frame.empty())
+                    break;
+                if (isDuplicate(ReportJournal::Camera, dHash(event.frame))) {
+                    appendRepeat(ReportJournal::Camera);
+                    break;
+                }
+                std::vector<uchar> jpeg;
+                if (cv::imencode(".jpg", event.frame, jpeg, {cv::IMWRITE_JPEG_QUALITY, 80}))
+                    journal.append(ReportJournal::CameraJpeg, jpeg.data(), static_cast<uint32_t>(jpeg.size()));
+                else
+                    LOG_ERROR("ReportWriter failed to encode frame");
+                break;
+            }
+            case Event::PageBreak:
+                journal.append(ReportJournal::PageBreak, nullptr, 0);
+                break;
+            case Event::View:
+                if (event.text != view) {
+                    view = event.text;
+                    have_last_hash[ReportJournal::Screen] = false;
+                }
+                break;
+            case Event::Save:
+                // A session under min_pages is discarded on purpose; marking it saved keeps Recover from bringing it back
+                if (!assemble(event.text, event.min_pages))
+                    LOG_INFO("ReportWriter discarded " + event.text + ", under " + std::to_string(event.min_pages) + " pages");
+                journal.append(ReportJournal::Saved, nullptr, 0);
+                break;
+            case Event::Reset:
+                journal.truncate();
+                have_last_hash = {};
+                view.clear();
+                break;
+            case Event::Recover:
+                if (journal.needsRecovery()) {
+                    LOG_WARN("ReportWriter recovering unsaved report into " + event.text);
+                    assemble(event.text, 0);
+                }
+                journal.truncate();
+                have_last_hash = {};
+                view.clear();
+                break;
+        }
+    }
+
+    // Difference hash: shrink to 9x8 luma and set one bit per horizontally adjacent pair that gets darker
+    static uint64_t dHash(const std::array<uint8_t, 72>& luma) {
+        uint64_t hash = 0;
+        for (int y = 0; y < 8; ++y)
+            for (int x = 0; x < 8; ++x)
+                hash = (hash << 1) | (luma[y * 9 + x] > luma[y * 9 + x + 1] ? 1 : 0);
+        return hash;
+    }
+
+    static uint64_t dHash(const QImage& image) {
+        QImage small = image.scaled(9, 8, Qt::IgnoreAspectRatio, Qt::SmoothTransformation).convertToFormat(QImage::Format_Grayscale8);
+        std::array<uint8_t, 72> luma;
+        for (int y = 0; y < 8; ++y)
+            std::copy_n(small.constScanLine(y), 9, luma.begin() + y * 9);
+        return dHash(luma);
+    }
+
+    static uint64_t dHash(const cv::Mat& frame) {
+        cv::Mat gray, small;
+        if (frame.channels() == 1)
+            gray = frame;
+        else
+            cv::cvtColor(frame, gray, frame.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+        cv::resize(gray, small, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+        std::array<uint8_t, 72> luma;
+        for (int y = 0; y < 8; ++y)
+            std::copy_n(small.ptr<uint8_t>(y), 9, luma.begin() + y * 9);
+        return dHash(luma);
+    }
+
+    // Compare against the last embedded image of the same source, not the last seen one, so a slow pan cannot drift
+    // past the threshold. Screen grabs and camera frames are interleaved, so each source keeps its own reference.
+    bool isDuplicate(ReportJournal::ImageSource source, uint64_t hash) {
+        ++images;
+        if (have_last_hash[source] && __builtin_popcountll(hash ^ last_hash[source]) <= DEDUP_DISTANCE) {
+            ++duplicates;
+            return true;
+        }
+        last_hash[source] = hash;
+        have_last_hash[source] = true;
+        return false;
+    }
+
+    void appendRepeat(ReportJournal::ImageSource source) {
+        uint8_t payload = source;
+        journal.append(ReportJournal::Repeat, &payload, 1);
+    }
+
+    // Replay the journal into PDFCreator one record at a time. Once a document holds VOLUME_IMAGE_BYTES of images it is
+    // written as <name>_partN.pdf and a new one is started, so peak memory does not depend on the session length.
+    bool assemble(const std::string& filename, int min_pages) {
+        auto start = std::chrono::steady_clock::now();
+        std::string stem = filename;
+        if (stem.size() > 4 && stem.compare(stem.size() - 4, 4, ".pdf") == 0)
+            stem.resize(stem.size() - 4);
+        int volumes = 0;
+        int pages = 0;
+        size_t volume_bytes = 0;
+        bool volume_used = false;    // records added since the last volume was written
+        // Last image per source: drawn again for a Repeat, re-embedded when one lands at the start of a new volume
+        std::array<std::vector<char>, 2> last_jpeg;
+        std::array<HPDF_Image, 2> last_image = {};
+        auto writeVolume = [&]() {
+            ++volumes;
+            pdf.saveToFile(stem + "_part" + std::to_string(volumes) + ".pdf");
+            pages += pdf.getPageCount();
+            pdf.reset();
+            last_image = {};
+            volume_bytes = 0;
+            volume_used = false;
+        };
+
+        pdf.reset();
+        journal.replay([&](ReportJournal::RecordType type, const std::vector<char>& payload) {
+            try {
+                if (type != ReportJournal::Saved)
+                    volume_used = true;
+                if (type == ReportJournal::Text) {
+                    pdf.addText(std::string(payload.begin(), payload.end()));
+                } else if (type == ReportJournal::PageBreak) {
+                    pdf.addPageBreak();
+                } else if (type == ReportJournal::Jpeg || type == ReportJournal::CameraJpeg) {
+                    int source = type == ReportJournal::CameraJpeg ? ReportJournal::Camera : ReportJournal::Screen;
+                    last_image[source] = pdf.addJpeg(reinterpret_cast<const unsigned char*>(payload.data()), payload.size());
+                    last_jpeg[source] = payload;
+                    volume_bytes += payload.size();
+                    if (volume_bytes >= VOLUME_IMAGE_BYTES)
+                        writeVolume();
+                } else if (type == ReportJournal::Repeat) {
+                    int source = !payload.empty() && payload[0] == ReportJournal::Camera ? ReportJournal::Camera : ReportJournal::Screen;
+                    if (last_image[source])
+                        pdf.addImageAgain(last_image[source]);
+                    else if (!last_jpeg[source].empty())
+                        last_image[source] = pdf.addJpeg(reinterpret_cast<const unsigned char*>(last_jpeg[source].data()), last_jpeg[source].size());
+                }
+            } catch (const std::exception& e) {
+                LOG_ERROR("ReportWriter skipped journal record: " + std::string(e.what()));
+            }
+        });
+
+        if (volumes == 0) {
+            if (pdf.getPageCount() < min_pages) {
+                pdf.reset();
+                return false;
+            }
+            pdf.saveToFile(filename);
+            pages = pdf.getPageCount();
+            pdf.reset();
+        } else if (volume_used) {
+            writeVolume();
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        LOG_INFO("ReportWriter saved " + filename + " (" + std::to_string(pages) + " pages, " + std::to_string(std::max(volumes, 1)) + " volumes, journal " + std::to_string(journal.bytesWritten()) + " bytes, dedup ratio " + std::to_string(dedupRatio()) + ") in " + std::to_string(ms) + " ms");
+        return true;
+    }
+
+    void WriteLoop() {
+        while (true) {
+            Event event;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cv.wait(lock, [this] { return stopping || !events.empty(); });
+                // Drain everything before honouring stop
+                if (events.empty())
+                    return;
+                event = std::move(events.front());
+                events.pop_front();
+            }
+            space_cv.notify_one();
+            try {
+                process(event);
+            } catch (const std::exception& e) {
+                LOG_ERROR("ReportWriter event error: " + std::string(e.what()));
+            }
+            ++written;
+        }
+    }
+};
+
+#endif // REPORTWRITER_H
@@ -0,0 +1,394 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+#include "Logger.h"
+
+class Scheduler;
+
+// What a periodic task does when a run ends after its next deadline
+enum class CatchUp {
+    Skip,     // drop the missed runs, stay on the original grid
+    Burst,    // run the missed ones back to back (at most MAX_BURST), stay on the grid
+    Shift     // run once now and move the grid to start from here
+};
+
+// Power-of-two microsecond buckets, 1 us .. ~16 s
+class LatencyHistogram {
+public:
+    void add(int64_t us) {
+        us = std::max<int64_t>(us, 0);
+        int bucket = 0;
+        while (bucket + 1 < BUCKETS && (int64_t(1) << bucket) < us)
+            ++bucket;
+        ++counts[bucket];
+        ++total;
+        max_us = std::max(max_us, us);
+    }
+
+    // Upper bound of the bucket holding the given quantile
+    int64_t quantile(double q) const {
+        uint64_t rank = static_cast<uint64_t>(q * total);
+        uint64_t seen = 0;
+        for (int bucket = 0; bucket < BUCKETS; ++bucket) {
+            seen += counts[bucket];
+            if (seen > rank)
+                return int64_t(1) << bucket;
+        }
+        return max_us;
+    }
+
+    std::string summary() const {
+        if (total == 0)
+            return "-";
+        return "p50<=" + std::to_string(quantile(0.5)) + "us p99<=" + std::to_string(quantile(0.99)) + "us max=" + std::to_string(max_us) + "us";
+    }
+
+private:
+    static constexpr int BUCKETS = 25;
+    uint64_t counts[BUCKETS] = {};
+    uint64_t total = 0;
+    int64_t max_us = 0;
+};
+
+struct TaskStats {
+    uint64_t runs = 0;
+    uint64_t missed = 0;    // deadlines that passed while the previous run was still going
+    LatencyHistogram lateness;    // start - deadline
+    LatencyHistogram runtime;
+
+    std::string summary() const {
+        return std::to_string(runs) + " runs, " + std::to_string(missed) + " missed, lateness " + lateness.summary() + ", runtime " + runtime.summary();
+    }
+};
+
+// One scheduled job. Shared by the wheel, the executor queue and the owner's TaskHandle.
+struct ScheduledTask {
+    std::function<void()> callback;
+    int interval_ms = 0;    // 0 = one-shot
+    CatchUp policy = CatchUp::Skip;
+    std::string name;
+    class Executor* executor = nullptr;
+    std::atomic<bool> cancelled{false};
+    std::mutex state_mutex;
+    std::condition_variable state_cv;
+    bool running = false;
+    std::thread::id runner;
+    std::chrono::steady_clock::time_point deadline;    // of the pending run
+    int burst = 0;    // catch-up runs taken in a row
+    TaskStats stats;    // guarded by state_mutex
+};
+
+// Cancellation token for a ScheduledTask; its stats stay readable after cancel(). cancel() returns once the callback is
+// not running, except when called from the callback itself, where it only marks the task so it neither runs nor re-arms.
+class TaskHandle {
+public:
+    TaskHandle() = default;
+    explicit TaskHandle(std::shared_ptr<ScheduledTask> _task) : task(std::move(_task)) {}
+
+    void cancel() {
+        if (!task)
+            return;
+        task->cancelled = true;
+        std::unique_lock<std::mutex> lock(task->state_mutex);
+        task->state_cv.wait(lock, [this] { return !task->running || task->runner == std::this_thread::get_id(); });
+    }
+
+    bool active() const {
+        return task && !task->cancelled;
+    }
+
+    TaskStats stats() const {
+        if (!task)
+            return TaskStats();
+        std::lock_guard<std::mutex> lock(task->state_mutex);
+        return task->stats;
+    }
+
+private:
+    std::shared_ptr<ScheduledTask> task;
+};
+
+// Single thread running the callbacks of the tasks dispatched to it, in order
+class Executor {
+public:
+    explicit Executor(const std::string& _name) : name(_name) {
+        worker = std::thread([this]() { RunLoop(); });
+        worker.detach();    // lives as long as the process, like the Scheduler
+    }
+
+    void post(std::shared_ptr<ScheduledTask> task) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue.push_back(std::move(task));
+        }
+        queue_cv.notify_one();
+    }
+
+    const std::string name;
+
+private:
+    std::thread worker;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<std::shared_ptr<ScheduledTask>> queue;
+
+    static constexpr int MAX_BURST = 8;
+
+    void RunLoop();
+    void rearm(const std::shared_ptr<ScheduledTask>& task, std::chrono::steady_clock::time_point finished);
+};
+
+// Process-wide scheduler: one thread drives a hierarchical timer wheel (1 ms ticks; levels of 256, 64, 64 and 64 slots
+// cover about 18 hours) and hands due tasks to named executors. The thread sleeps until the next slot that holds a
+// task or must be cascaded, so idle timers cost no wakeups. Replaces one sleeping thread per Timer.
+class Scheduler {
+public:
+    static Scheduler& instance() {
+        // Never destroyed; Timers owned by static objects may still cancel during exit
+        static Scheduler* scheduler = new Scheduler();
+        return *scheduler;
+    }
+
+    // Run callback after delay_ms and then every interval_ms (0 = once) on the named executor. Periodic runs are due at
+    // fixed steady-clock deadlines, start + k * interval, so a run's duration does not shift the ones after it.
+    TaskHandle schedule(std::function<void()> callback, int delay_ms, int interval_ms, const std::string& executor_name = "default", const std::string& name = "", CatchUp policy = CatchUp::Skip) {
+        auto task = std::make_shared<ScheduledTask>();
+        task->callback = std::move(callback);
+        task->interval_ms = interval_ms;
+        task->policy = policy;
+        task->name = name;
+        task->executor = &executor(executor_name);
+        arm(task, std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(delay_ms, 0)));
+        return TaskHandle(task);
+    }
+
+    Executor& executor(const std::string& name) {
+        std::lock_guard<std::mutex> lock(executors_mutex);
+        auto& slot = executors[name];
+        if (!slot) {
+            LOG_INFO("Scheduler starting executor " + name);
+            slot.reset(new Executor(name));
+        }
+        return *slot;
+    }
+
+    // Put a task back on the wheel for its next run
+    void arm(const std::shared_ptr<ScheduledTask>& task, std::chrono::steady_clock::time_point when) {
+        task->deadline = when;
+        {
+            std::lock_guard<std::mutex> lock(wheel_mutex);
+            // Round up so a run never starts before its deadline
+            uint64_t deadline = std::max(toTick(when + std::chrono::microseconds(999)), current_tick + 1);
+            insert(Entry{task, deadline});
+        }
+        wheel_cv.notify_one();
+    }
+
+private:
+    static constexpr int LEVELS = 4;
+    static constexpr int LEVEL0_BITS = 8;
+    static constexpr int LEVEL_BITS = 6;
+
+    struct Entry {
+        std::shared_ptr<ScheduledTask> task;
+        uint64_t deadline;    // tick
+    };
+
+    std::chrono::steady_clock::time_point epoch;
+    uint64_t current_tick = 0;    // last processed tick
+    std::vector<std::vector<Entry>> slots[LEVELS];
+    std::mutex wheel_mutex;
+    std::condition_variable wheel_cv;
+    std::thread wheel_thread;
+    std::mutex executors_mutex;
+    std::map<std::string, std::unique_ptr<Executor>> executors;
+
+    Scheduler() : epoch(std::chrono::steady_clock::now()) {
+        for (int level = 0; level < LEVELS; ++level)
+            slots[level].resize(slotCount(level));
+        wheel_thread = std::thread([this]() { WheelLoop(); });
+        wheel_thread.detach();
+    }
+
+    static int slotCount(int level) {
+        return level == 0 ? 1 << LEVEL0_BITS : 1 << LEVEL_BITS;
+    }
+
+    // Ticks covered by one slot of a level
+    static int shiftOf(int level) {
+        return level == 0 ? 0 : LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+    }
+
+    uint64_t toTick(std::chrono::steady_clock::time_point when) const {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(when - epoch).count();
+        return ms > 0 ? static_cast<uint64_t>(ms) : 0;
+    }
+
+    // Place an entry in the lowest level whose span reaches its deadline. Deadlines beyond the wheel are parked in
+    // its farthest slot and re-inserted when they come round.
+    void insert(Entry entry) {
+        uint64_t span = uint64_t(1) << (shiftOf(LEVELS - 1) + LEVEL_BITS);
+        uint64_t tick = std::min(std::max(entry.deadline, current_tick), current_tick + span - 1);
+        uint64_t delta = tick - current_tick;
+        int level = 0;
+        while (level + 1 < LEVELS && delta >= (uint64_t(1) << shiftOf(level + 1)))
+            ++level;
+        size_t index = static_cast<size_t>((tick >> shiftOf(level)) & (slotCount(level) - 1));
+        slots[level][index].push_back(std::move(entry));
+    }
+
+    // Next tick at which something is due or must be cascaded; 0 if the wheel is empty
+    uint64_t nextWakeTick() const {
+        uint64_t best = 0;
+        for (int level = 0; level < LEVELS; ++level) {
+            int shift = shiftOf(level);
+            uint64_t base = current_tick >> shift;
+            for (int k = 1; k <= slotCount(level); ++k) {
+                size_t index = static_cast<size_t>((base + k) & (slotCount(level) - 1));
+                if (!slots[level][index].empty()) {
+                    uint64_t tick = (base + k) << shift;
+                    if (best == 0 || tick < best)
+                        best = tick;
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+    void cascade(int level) {
+        size_t index = static_cast<size_t>((current_tick >> shiftOf(level)) & (slotCount(level) - 1));
+        std::vector<Entry> entries;
+        entries.swap(slots[level][index]);
+        for (auto& entry : entries)
+            insert(std::move(entry));
+    }
+
+    void advance(std::vector<Entry>& due) {
+        ++current_tick;
+        for (int level = 1; level < LEVELS; ++level) {
+            if (current_tick & ((uint64_t(1) << shiftOf(level)) - 1))
+                break;
+            cascade(level);
+        }
+        std::vector<Entry> entries;
+        entries.swap(slots[0][current_tick & (slotCount(0) - 1)]);
+        for (auto& entry : entries) {
+            if (entry.deadline <= current_tick)
+                due.push_back(std::move(entry));
+            else
+                insert(std::move(entry));
+        }
+    }
+
+    void WheelLoop() {
+        std::vector<Entry> due;
+        std::unique_lock<std::mutex> lock(wheel_mutex);
+        while (true) {
+            uint64_t now_tick = toTick(std::chrono::steady_clock::now());
+            while (current_tick < now_tick)
+                advance(due);
+            if (!due.empty()) {
+                lock.unlock();
+                for (auto& entry : due) {
+                    if (!entry.task->cancelled)
+                        entry.task->executor->post(std::move(entry.task));
+                }
+                due.clear();
+                lock.lock();
+                continue;
+            }
+            uint64_t wake = nextWakeTick();
+            if (wake == 0)
+                wheel_cv.wait(lock);
+            else
+                wheel_cv.wait_until(lock, epoch + std::chrono::milliseconds(wake));
+        }
+    }
+};
+
+inline void Executor::RunLoop() {
+    while (true) {
+        std::shared_ptr<ScheduledTask> task;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this] { return !queue.empty(); });
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(task->state_mutex);
+            if (task->cancelled)
+                continue;
+            task->running = true;
+            task->runner = std::this_thread::get_id();
+        }
+        try {
+            task->callback();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Scheduler task " + task->name + " on " + name + " failed: " + std::string(e.what()));
+        }
+        auto finished = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(task->state_mutex);
+            task->running = false;
+            task->runner = std::thread::id();
+            task->stats.runs++;
+            task->stats.lateness.add(std::chrono::duration_cast<std::chrono::microseconds>(start - task->deadline).count());
+            task->stats.runtime.add(std::chrono::duration_cast<std::chrono::microseconds>(finished - start).count());
+        }
+        task->state_cv.notify_all();
+        if (task->interval_ms > 0 && !task->cancelled)
+            rearm(task, finished);
+    }
+}
+
+inline void Executor::rearm(const std::shared_ptr<ScheduledTask>& task, std::chrono::steady_clock::time_point finished) {
+    auto interval = std::chrono::milliseconds(task->interval_ms);
+    auto next = task->deadline + interval;
+    if (next > finished) {
+        task->burst = 0;
+        Scheduler::instance().arm(task, next);
+        return;
+    }
+    // The run overran: next, and possibly more deadlines after it, have already passed
+    uint64_t passed = static_cast<uint64_t>((finished - next) / interval) + 1;
+    CatchUp policy = task->policy;
+    if (policy == CatchUp::Burst && task->burst >= MAX_BURST)
+        policy = CatchUp::Skip;    // too far behind to catch up
+    uint64_t missed = 0;
+    switch (policy) {
+        case CatchUp::Burst:
+            ++task->burst;
+            break;
+        case CatchUp::Skip:
+            next += interval * passed;
+            missed = passed;
+            task->burst = 0;
+            break;
+        case CatchUp::Shift:
+            next = finished;
+            missed = passed - 1;
+            task->burst = 0;
+            break;
+    }
+    {
+        std::lock_guard<std::mutex> lock(task->state_mutex);
+        task->stats.missed += missed;
+    }
+    Scheduler::instance().arm(task, next);
+}
+
+#endif // SCHEDULER_H
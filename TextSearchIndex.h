@@ -0,0 +1,548 @@
+#ifndef TEXTSEARCHINDEX_H
+#define TEXTSEARCHINDEX_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <QString>
+#include <QChar>
+#include <QRectF>
+#include <poppler-qt5.h>
+#include "Logger.h"
+
+// Inverted index over the text of the Standalone PDFs (per page) and TXT task files (per task line).
+// Terms are partitioned by script (Latin, Cyrillic, Arabic, digits), one partition per supported language,
+// and stored next to the file catalog. Only files whose size or mtime changed are re-extracted.
+class TextSearchIndex {
+public:
+    struct Hit {
+        std::string name;
+        std::string path;
+        int page;           // 0-based PDF page, or TXT task line
+        int score;          // number of query terms found on that page
+    };
+
+    TextSearchIndex(const std::string& _index_path) : index_path(_index_path), running(false), stop_requested(false), rescan_pending(false) {
+        LOG_INFO("TextSearchIndex Constructor");
+        load();
+    }
+
+    ~TextSearchIndex() {
+        stop_requested = true;
+        if (indexer.joinable()) {
+            indexer.join();
+        }
+    }
+
+    TextSearchIndex(const TextSearchIndex&) = delete;
+    TextSearchIndex& operator=(const TextSearchIndex&) = delete;
+
+    // Rescan folder on the indexer thread; a request while a scan is running queues one more pass
+    void startIndexing(const std::string& _folder) {
+        try {
+            std::lock_guard<std::mutex> state_lock(state_mutex);
+            folder = _folder;
+            if (running) {
+                rescan_pending = true;
+                return;
+            }
+            if (indexer.joinable()) {
+                indexer.join();
+            }
+            running = true;
+            indexer = std::thread([this]() { IndexLoop(); });
+        } catch (const std::exception& e) {
+            running = false;
+            LOG_ERROR("TextSearchIndex startIndexing error: " + std::string(e.what()));
+        }
+    }
+
+    bool isIndexing() const {
+        return running;
+    }
+
+    // Called on the indexer thread when a scan (and any queued rescan) has finished
+    void setUpdatedCallback(std::function<void()> callback) {
+        updated_callback = callback;
+    }
+
+    // Up to max_terms terms in the script of like_word, plus numbers, for a speech grammar. Terms on more than
+    // MAX_VOICE_PAGE_SHARE of the pages (stop words) are left out; the rest rank by document frequency times
+    // inverse document frequency, which favours words that pick out a few pages over both noise and filler.
+    std::vector<std::string> vocabulary(const std::string& like_word, size_t max_terms) {
+        std::vector<std::string> words;
+        try {
+            int script = SCRIPT_COMMON;
+            tokenize(QString::fromStdString(like_word), [&script](int term_script, const std::string&) {
+                if (script == SCRIPT_COMMON)
+                    script = term_script;
+            });
+            if (script == SCRIPT_COMMON)
+                return words;
+            std::vector<std::pair<double, std::string>> ranked;
+            {
+                std::lock_guard<std::mutex> lock(index_mutex);
+                double pages = static_cast<double>(std::max<size_t>(pageCount(), 1));
+                for (int s : {script, static_cast<int>(SCRIPT_COMMON)}) {
+                    for (const auto& kv : partitions[s]) {
+                        double df = static_cast<double>(kv.second.size());
+                        if (df > pages * MAX_VOICE_PAGE_SHARE && pages >= MIN_PAGES_FOR_STOP_WORDS)
+                            continue;
+                        ranked.emplace_back(df * std::log(1.0 + pages / df), kv.first);
+                    }
+                }
+            }
+            size_t count = std::min(max_terms, ranked.size());
+            std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                              [](const auto& a, const auto& b) { return a.first > b.first; });
+            for (size_t i = 0; i < count; ++i)
+                words.push_back(ranked[i].second);
+        } catch (const std::exception& e) {
+            LOG_ERROR("TextSearchIndex vocabulary error: " + std::string(e.what()));
+        }
+        return words;
+    }
+
+    // Pages containing the query terms, best first. Pages with every term rank above partial matches.
+    // suffix restricts hits to ".pdf" or ".txt"; prefer_path ranks hits in that document first on ties.
+    std::vector<Hit> query(const std::string& text, const std::string& suffix = "", const std::string& prefer_path = "", size_t max_hits = 10) {
+        std::vector<Hit> hits;
+        try {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::pair<int, std::string>> terms;
+            tokenize(QString::fromStdString(text), [&terms](int script, const std::string& term) {
+                terms.emplace_back(script, term);
+            });
+            if (terms.empty())
+                return hits;
+            std::map<Posting, int> scores;
+            std::lock_guard<std::mutex> lock(index_mutex);
+            for (const auto& term : terms) {
+                const Partition& partition = partitions[term.first];
+                auto it = partition.find(term.second);
+                if (it == partition.end())
+                    continue;
+                for (const Posting& posting : it->second)
+                    ++scores[posting];
+            }
+            for (const auto& kv : scores) {
+                auto doc = documents.find(kv.first.doc);
+                if (doc == documents.end() || (!suffix.empty() && !hasSuffix(doc->second.name, suffix)))
+                    continue;
+                hits.push_back({doc->second.name, doc->second.path, static_cast<int>(kv.first.page), kv.second});
+            }
+            std::stable_sort(hits.begin(), hits.end(), [&prefer_path](const Hit& a, const Hit& b) {
+                if (a.score != b.score)
+                    return a.score > b.score;
+                return (a.path == prefer_path) > (b.path == prefer_path);
+            });
+            if (hits.size() > max_hits)
+                hits.resize(max_hits);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            LOG_INFO("TextSearchIndex query \"" + text + "\": " + std::to_string(hits.size()) + " hits in " + std::to_string(ms) + " ms");
+        } catch (const std::exception& e) {
+            LOG_ERROR("TextSearchIndex query error: " + std::string(e.what()));
+        }
+        return hits;
+    }
+
+private:
+    static constexpr uint32_t INDEX_MAGIC = 0x31495354; // "TSI1"
+    static constexpr double MAX_VOICE_PAGE_SHARE = 0.3;
+    static constexpr double MIN_PAGES_FOR_STOP_WORDS = 20;    // below this every page share is too coarse to tell
+    enum Script { SCRIPT_COMMON = 0, SCRIPT_LATIN, SCRIPT_CYRILLIC, SCRIPT_ARABIC, SCRIPT_OTHER, SCRIPT_COUNT };
+
+    struct Document {
+        std::string name;
+        std::string path;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+    };
+
+    struct Posting {
+        uint32_t doc;
+        uint32_t page;
+        bool operator<(const Posting& other) const {
+            return doc != other.doc ? doc < other.doc : page < other.page;
+        }
+        bool operator==(const Posting& other) const {
+            return doc == other.doc && page == other.page;
+        }
+    };
+
+    using Partition = std::map<std::string, std::vector<Posting>>;   // term -> sorted postings
+
+    std::string index_path;
+    std::string folder;
+    std::map<uint32_t, Document> documents;
+    std::array<Partition, SCRIPT_COUNT> partitions;
+    uint32_t next_doc = 0;
+    std::mutex index_mutex;
+    std::mutex state_mutex;                // running / rescan_pending handshake
+    std::thread indexer;
+    std::atomic<bool> running;
+    std::atomic<bool> stop_requested;
+    std::atomic<bool> rescan_pending;
+    std::function<void()> updated_callback;
+
+    // Indexed pages (PDF pages and task lines) that hold at least one term. Caller holds index_mutex.
+    size_t pageCount() const {
+        std::set<Posting> pages;
+        for (const Partition& partition : partitions)
+            for (const auto& kv : partition)
+                pages.insert(kv.second.begin(), kv.second.end());
+        return pages.size();
+    }
+
+    static bool hasSuffix(const std::string& name, const std::string& suffix) {
+        return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    static int scriptOf(QChar c) {
+        if (c.isDigit())
+            return SCRIPT_COMMON;
+        switch (c.script()) {
+            case QChar::Script_Latin: return SCRIPT_LATIN;
+            case QChar::Script_Cyrillic: return SCRIPT_CYRILLIC;
+            case QChar::Script_Arabic: return SCRIPT_ARABIC;
+            default: return SCRIPT_OTHER;
+        }
+    }
+
+    // Lowercased letter/digit runs with Arabic diacritics dropped. A run's script is that of its first letter,
+    // so part numbers such as "AB12" land in the Latin partition and plain numbers in the common one.
+    static void tokenize(const QString& text, const std::function<void(int, const std::string&)>& emit) {
+        QString term;
+        int script = SCRIPT_COMMON;
+        auto flush = [&]() {
+            if (term.size() >= 2 || (term.size() == 1 && term[0].isDigit()))
+                emit(script, term.toUtf8().toStdString());
+            term.clear();
+            script = SCRIPT_COMMON;
+        };
+        for (QChar c : text) {
+            if (c.isMark())
+                continue;
+            if (c.isLetterOrNumber()) {
+                if (script == SCRIPT_COMMON && c.isLetter())
+                    script = scriptOf(c);
+                term += c.toLower();
+            }
+            else
+                flush();
+        }
+        flush();
+    }
+
+    static void addTerms(const QString& text, uint32_t doc, uint32_t page, std::array<Partition, SCRIPT_COUNT>& target) {
+        tokenize(text, [&](int script, const std::string& term) {
+            std::vector<Posting>& postings = target[script][term];
+            Posting posting{doc, page};
+            if (postings.empty() || !(postings.back() == posting))
+                postings.push_back(posting);
+        });
+    }
+
+    bool extract(const std::string& path, uint32_t doc, std::array<Partition, SCRIPT_COUNT>& target) {
+        if (hasSuffix(path, ".pdf")) {
+            std::unique_ptr<Poppler::Document> pdf(Poppler::Document::load(QString::fromStdString(path)));
+            if (!pdf || pdf->isLocked())
+                return false;
+            for (int i = 0; i < pdf->numPages() && !stop_requested; ++i) {
+                std::unique_ptr<Poppler::Page> page(pdf->page(i));
+                if (page)
+                    addTerms(page->text(QRectF()), doc, static_cast<uint32_t>(i), target);
+            }
+            return true;
+        }
+        std::ifstream in(path);
+        if (!in.is_open())
+            return false;
+        std::string line;
+        uint32_t index = 0;
+        // Same numbering as CameraViewer::loadTasks, which keeps every line as a task
+        while (std::getline(in, line))
+            addTerms(QString::fromStdString(line), doc, index++, target);
+        return true;
+    }
+
+    // Caller holds index_mutex
+    void removeDocuments(const std::set<uint32_t>& ids) {
+        if (ids.empty())
+            return;
+        for (Partition& partition : partitions) {
+            for (auto it = partition.begin(); it != partition.end();) {
+                auto& postings = it->second;
+                postings.erase(std::remove_if(postings.begin(), postings.end(),
+                                              [&ids](const Posting& p) { return ids.count(p.doc) > 0; }),
+                               postings.end());
+                if (postings.empty())
+                    it = partition.erase(it);
+                else
+                    ++it;
+            }
+        }
+        for (uint32_t id : ids)
+            documents.erase(id);
+    }
+
+    void IndexLoop() {
+        while (!stop_requested) {
+            std::string scan_folder;
+            {
+                std::lock_guard<std::mutex> state_lock(state_mutex);
+                rescan_pending = false;
+                scan_folder = folder;
+            }
+            IndexOnce(scan_folder);
+            {
+                std::lock_guard<std::mutex> state_lock(state_mutex);
+                if (rescan_pending && !stop_requested)
+                    continue;
+                running = false;
+            }
+            if (updated_callback && !stop_requested)
+                updated_callback();
+            return;
+        }
+        running = false;
+    }
+
+    void IndexOnce(const std::string& scan_folder) {
+        try {
+            auto start = std::chrono::steady_clock::now();
+            std::map<std::string, Document> on_disk;
+            std::error_code ec;
+            for (const auto& file : std::filesystem::directory_iterator(scan_folder, ec)) {
+                if (!file.is_regular_file())
+                    continue;
+                std::string name = file.path().filename().string();
+                if (!hasSuffix(name, ".pdf") && !hasSuffix(name, ".txt"))
+                    continue;
+                Document doc;
+                doc.name = name;
+                doc.path = file.path().string();
+                doc.size = static_cast<uint64_t>(file.file_size());
+                doc.mtime = static_cast<int64_t>(file.last_write_time().time_since_epoch().count());
+                on_disk[name] = doc;
+            }
+            if (ec) {
+                LOG_WARN("TextSearchIndex can't list " + scan_folder);
+                return;
+            }
+            // Work out what changed against the current index
+            std::set<uint32_t> stale;
+            std::vector<Document> changed;
+            {
+                std::lock_guard<std::mutex> lock(index_mutex);
+                std::set<std::string> unchanged;
+                for (const auto& kv : documents) {
+                    auto it = on_disk.find(kv.second.name);
+                    if (it != on_disk.end() && it->second.path == kv.second.path &&
+                        it->second.size == kv.second.size && it->second.mtime == kv.second.mtime)
+                        unchanged.insert(kv.second.name);
+                    else
+                        stale.insert(kv.first);
+                }
+                for (const auto& kv : on_disk) {
+                    if (!unchanged.count(kv.first))
+                        changed.push_back(kv.second);
+                }
+            }
+            if (stale.empty() && changed.empty())
+                return;
+            // Extract the changed files without holding the lock, so queries keep working meanwhile
+            std::array<Partition, SCRIPT_COUNT> fresh;
+            std::map<uint32_t, Document> fresh_docs;
+            uint32_t id;
+            {
+                std::lock_guard<std::mutex> lock(index_mutex);
+                id = next_doc;
+                next_doc += static_cast<uint32_t>(changed.size());
+            }
+            for (const Document& doc : changed) {
+                if (stop_requested)
+                    return;
+                if (extract(doc.path, id, fresh))
+                    fresh_docs[id] = doc;
+                else
+                    LOG_WARN("TextSearchIndex can't read " + doc.path);
+                ++id;
+            }
+            size_t terms = 0;
+            {
+                std::lock_guard<std::mutex> lock(index_mutex);
+                removeDocuments(stale);
+                for (int s = 0; s < SCRIPT_COUNT; ++s) {
+                    for (auto& kv : fresh[s]) {
+                        std::vector<Posting>& postings = partitions[s][kv.first];
+                        postings.insert(postings.end(), kv.second.begin(), kv.second.end());
+                        std::sort(postings.begin(), postings.end());
+                    }
+                    terms += partitions[s].size();
+                }
+                documents.insert(fresh_docs.begin(), fresh_docs.end());
+            }
+            save();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            LOG_INFO("TextSearchIndex indexed " + std::to_string(fresh_docs.size()) + " files, dropped " + std::to_string(stale.size()) +
+                     ", " + std::to_string(terms) + " terms in " + std::to_string(ms) + " ms");
+        } catch (const std::exception& e) {
+            LOG_ERROR("TextSearchIndex IndexOnce error: " + std::string(e.what()));
+        }
+    }
+
+    static void writeVarint(std::ofstream& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.put(static_cast<char>((v & 0x7F) | 0x80));
+            v >>= 7;
+        }
+        out.put(static_cast<char>(v));
+    }
+
+    static bool readVarint(std::ifstream& in, uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int c = in.get();
+            if (c == EOF)
+                return false;
+            v |= static_cast<uint64_t>(c & 0x7F) << shift;
+            if (!(c & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    static void writeString(std::ofstream& out, const std::string& s) {
+        writeVarint(out, s.size());
+        out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+    static bool readString(std::ifstream& in, std::string& s) {
+        uint64_t size;
+        if (!readVarint(in, size) || size > (1u << 20))
+            return false;
+        s.resize(size);
+        return static_cast<bool>(in.read(&s[0], static_cast<std::streamsize>(size)));
+    }
+
+    // Postings are delta-encoded varints: documents ascending, pages ascending within a document
+    void save() {
+        try {
+            std::error_code ec;
+            std::filesystem::create_directories(std::filesystem::path(index_path).parent_path(), ec);
+            std::string tmp = index_path + ".tmp";
+            {
+                std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+                if (!out.is_open()) {
+                    LOG_WARN("TextSearchIndex can't write " + tmp);
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(index_mutex);
+                out.write(reinterpret_cast<const char*>(&INDEX_MAGIC), sizeof(INDEX_MAGIC));
+                writeVarint(out, next_doc);
+                writeVarint(out, documents.size());
+                for (const auto& kv : documents) {
+                    writeVarint(out, kv.first);
+                    writeString(out, kv.second.name);
+                    writeString(out, kv.second.path);
+                    writeVarint(out, kv.second.size);
+                    writeVarint(out, static_cast<uint64_t>(kv.second.mtime));
+                }
+                for (const Partition& partition : partitions) {
+                    writeVarint(out, partition.size());
+                    for (const auto& kv : partition) {
+                        writeString(out, kv.first);
+                        writeVarint(out, kv.second.size());
+                        uint32_t last_doc = 0, last_page = 0;
+                        for (const Posting& p : kv.second) {
+                            writeVarint(out, p.doc - last_doc);
+                            writeVarint(out, p.doc == last_doc ? p.page - last_page : p.page);
+                            last_doc = p.doc;
+                            last_page = p.page;
+                        }
+                    }
+                }
+                if (!out) {
+                    LOG_WARN("TextSearchIndex write failed " + tmp);
+                    return;
+                }
+            }
+            std::filesystem::rename(tmp, index_path, ec);
+            if (ec)
+                LOG_WARN("TextSearchIndex can't replace " + index_path);
+        } catch (const std::exception& e) {
+            LOG_ERROR("TextSearchIndex save error: " + std::string(e.what()));
+        }
+    }
+
+    void load() {
+        try {
+            std::ifstream in(index_path, std::ios::binary);
+            if (!in.is_open())
+                return;
+            uint32_t magic = 0;
+            in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+            uint64_t next, count;
+            if (!in || magic != INDEX_MAGIC || !readVarint(in, next) || !readVarint(in, count)) {
+                LOG_WARN("TextSearchIndex ignoring unreadable " + index_path);
+                return;
+            }
+            std::map<uint32_t, Document> docs;
+            for (uint64_t i = 0; i < count; ++i) {
+                uint64_t id, size, mtime;
+                Document doc;
+                if (!readVarint(in, id) || !readString(in, doc.name) || !readString(in, doc.path) ||
+                    !readVarint(in, size) || !readVarint(in, mtime))
+                    return;
+                doc.size = size;
+                doc.mtime = static_cast<int64_t>(mtime);
+                docs[static_cast<uint32_t>(id)] = doc;
+            }
+            std::array<Partition, SCRIPT_COUNT> parts;
+            for (Partition& partition : parts) {
+                uint64_t terms;
+                if (!readVarint(in, terms))
+                    return;
+                for (uint64_t t = 0; t < terms; ++t) {
+                    std::string term;
+                    uint64_t postings_count;
+                    if (!readString(in, term) || !readVarint(in, postings_count))
+                        return;
+                    std::vector<Posting>& postings = partition[term];
+                    postings.reserve(postings_count);
+                    uint32_t doc = 0, page = 0;
+                    for (uint64_t p = 0; p < postings_count; ++p) {
+                        uint64_t doc_delta, page_value;
+                        if (!readVarint(in, doc_delta) || !readVarint(in, page_value))
+                            return;
+                        page = doc_delta == 0 ? page + static_cast<uint32_t>(page_value) : static_cast<uint32_t>(page_value);
+                        doc += static_cast<uint32_t>(doc_delta);
+                        postings.push_back({doc, page});
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> lock(index_mutex);
+            next_doc = static_cast<uint32_t>(next);
+            documents.swap(docs);
+            partitions.swap(parts);
+            LOG_INFO("TextSearchIndex loaded " + std::to_string(documents.size()) + " files");
+        } catch (const std::exception& e) {
+            LOG_ERROR("TextSearchIndex load error: " + std::string(e.what()));
+        }
+    }
+};
+
+#endif // TEXTSEARCHINDEX_H
@@ -2,36 +2,21 @@
 #define Timer_H
 
 #include <iostream>
-#include <thread>
+#include <string>
 #include <functional>
-#include <atomic>
 #include <chrono>
+#include "Scheduler.h"
 
+// Periodic callback on a named Scheduler executor; no thread of its own. stop() may be called from the callback.
+// Runs are due every interval_ms on a fixed grid from start(); policy decides what happens after an overrun.
 class Timer {
 public:
-    Timer() : running(false) {}
+    explicit Timer(const std::string& _executor = "default", const std::string& _name = "") : executor(_executor), name(_name) {}
 
-    void start(int interval_ms, int _type, std::function<void()> callback) {
+    void start(int interval_ms, std::function<void()> callback, CatchUp policy = CatchUp::Skip) {
         try {
             stop();
-            running = true;
-
-            timer_thread = std::thread([=]() {
-                while (running) {
-                    if (_type == 0) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
-                    }
-                    else if (_type == 2){
-                        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
-                    }
-                    else if (_type == 1){
-                        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms/4));
-                    }
-                    if (running) {
-                        callback();
-                    }
-                }
-            });
+            handle = Scheduler::instance().schedule(callback, interval_ms, interval_ms, executor, name, policy);
         } catch (const std::exception& e) {
             LOG_ERROR("Something went wrong in start Timer: " + std::string(e.what()));
         }
@@ -39,10 +24,12 @@ public:
 
     void stop() {
         try {
-            running = false;
-            if (timer_thread.joinable()) {
-                timer_thread.join();
-            }
+            if (!handle.active())
+                return;
+            handle.cancel();
+            TaskStats stats = handle.stats();
+            if (stats.runs > 0)
+                LOG_INFO("Timer " + (name.empty() ? executor : name) + ": " + stats.summary());
         } catch (const std::exception& e) {
             LOG_ERROR("Something went wrong in stop Timer: " + std::string(e.what()));
         }
@@ -52,9 +39,14 @@ public:
         stop();
     }
 
+    TaskStats stats() const {
+        return handle.stats();
+    }
+
 private:
-    std::thread timer_thread;
-    std::atomic<bool> running;
+    std::string executor;
+    std::string name;
+    TaskHandle handle;
 };
 
-#endif // Timer_H
\ No newline at end of file
+#endif // Timer_H
@@ -93,11 +93,17 @@ CameraViewer::CameraViewer(QWidget *parent)
     clicktimer(new QTimer(this)),
     helptimer(new QTimer(this)),
     stoptimer(new QTimer(this)),
+    pdf(config.cache_folder + "report.journal"),
+    catalog(config.cache_folder + "catalog.bin"),
+    searchIndex(config.cache_folder + "search.idx"),
+    pageCache(config.cache_folder + "pages/", static_cast<size_t>(config.page_cache_mb) * 1024 * 1024),
+    pageRenderer(static_cast<size_t>(config.render_cache_mb) * 1024 * 1024),
     top_left(337, 57), 
     bottom_right(942, 662) {    
     try {
         // Set some fixed sizes for labels to ensure visibility 
         LOG_INFO("CameraViewer Constructor");           
+        pdf.recover(lang.getText("pdf_message","name") + getCurrentDateTime() + "_recovered.pdf");
         gst_init(nullptr, nullptr);
         Display* display = XOpenDisplay(NULL);
         if (display == NULL) {
@@ -216,6 +222,26 @@ CameraViewer::CameraViewer(QWidget *parent)
                 handle_update_video(_frame);
             });
         });  
+
+        pageRenderer.setDiskCache(&pageCache);
+        pageRenderer.setRenderedCallback([this](uint64_t _generation, int _page, float _zoom, const QRect& _region, const QImage& _image) {
+            QMetaObject::invokeMethod(this, [this, _generation, _page, _zoom, _region, _image]() {
+                handle_page_rendered(_generation, _page, _zoom, _region, _image);
+            }, Qt::QueuedConnection);
+        });
+
+        catalog.setUpdatedCallback([this]() {
+            QMetaObject::invokeMethod(this, [this]() {
+                handle_catalog_updated();
+            }, Qt::QueuedConnection);
+        });
+
+        searchIndex.setUpdatedCallback([this]() {
+            QMetaObject::invokeMethod(this, [this]() {
+                updateVoiceGrammar();
+            }, Qt::QueuedConnection);
+        });
+        updateVoiceGrammar();
         if (config.testbench == 0) {
             if (imuThread->init() == 0) {
                 imuThread->setResultCallback([this](const QString _label) {
@@ -223,7 +249,12 @@ CameraViewer::CameraViewer(QWidget *parent)
                         handleIMUClassification(_label);
                     });
                 });  
-                imuThread->start_IMU(config.status_update);
+                imuThread->setFallCallback([this](const FallEvent& _event) {
+                    QMetaObject::invokeMethod(this, [this, _event]() {
+                        handleFallEvent(_event);
+                    });
+                });
+                imuThread->start_IMU();
             }
 
             pm.set_battery_status_callback([this](PowerManagement::BatteryStatus status) {
@@ -258,6 +289,7 @@ CameraViewer::~CameraViewer() {
         delete videoPixmapItem2;
         videoPixmapItem2 = nullptr;
     }
+    pageRenderer.stop();
     if (document)
         delete document;
     if (imuThread && config.testbench == 0) {
@@ -435,6 +467,7 @@ QWidget* CameraViewer::createNavigationWidget() {
         listFiles->setMaximumHeight(0.95*Sheight);
         listFiles->setFont([](int size) { QFont font; font.setPointSize(size); return font; }(config.font_size));        
         listFiles->setStyleSheet("QListWidget { color : green; font-weight: bold;}");
+        listFiles->setIconSize(QSize(FileCatalog::THUMB_WIDTH, FileCatalog::THUMB_WIDTH * 3 / 4));
         
         std::string navJsonStr = lang.getSection("Navigationtab");        
         // Parse the JSON string
@@ -1493,8 +1526,7 @@ void CameraViewer::report_and_reset_clicks() {
                     }
                     else if (clicks == 6) {
                         cameraThread->releasecamera();    
-                        if (pdf.getPageCount() > 2)
-                            pdf.saveToFile(lang.getText("pdf_message","name")+getCurrentDateTime()+".pdf");
+                        pdf.save(lang.getText("pdf_message","name")+getCurrentDateTime()+".pdf", 3);
                         if (config.debug == 0) {
                             network.enable_wifi();
                             int Wconnected = 2;
@@ -1647,17 +1679,15 @@ void CameraViewer::report_and_reset_clicks() {
                     else if (clicks == 8)
                         scrollRight();
                     else if (clicks == 9) {
-                        if (cameraThread->takeSnapshot(config.snapshot_file)) {
-                            pdf.addImage("/home/x_user/my_camera_project/snapshot.png");
-                            pdf.addText("------------------------------------------------");
-                        }
+                        reportSnapshot();
                     } 
                     else if (clicks == 10) {
                         scenaraio = 1;
                         currentPage = 0;
-                        zoomFactor = 1.5;
-                        scene->clear();
+                        zoomFactor = PageRenderer::DEFAULT_ZOOM;
+                        clearPageScene();
                         document = nullptr;
+                        pageRenderer.close();
                         pdfFiles.clear();
                         showFilesList(config.todo,".pdf");
                         cameraThread->stopCapturing();
@@ -1671,15 +1701,12 @@ void CameraViewer::report_and_reset_clicks() {
                         prevTask();
                     }                    
                     else if (clicks == 3) {
-                        if (cameraThread->takeSnapshot(config.snapshot_file)) {
-                            pdf.addImage("/home/x_user/my_camera_project/snapshot.png");
-                            pdf.addText("------------------------------------------------");
-                        }
+                        reportSnapshot();
                     }
                     else if (clicks == 4) {
                         scenaraio = 2;
                         currentTaskIndex = 0;
-                        scene->clear();
+                        clearPageScene();
                         txtFiles.clear();
                         showFilesList(config.todo,".txt");
                         cameraThread->stopCapturing();
@@ -1713,20 +1740,18 @@ void CameraViewer::report_and_reset_clicks() {
                         scrollLeft();
                     }
                     else if (clicks == 9) {
-                        if (cameraThread->takeSnapshot(config.snapshot_file)) {
-                            pdf.addImage("/home/x_user/my_camera_project/snapshot.png");
-                            pdf.addText("------------------------------------------------");
-                        }
+                        reportSnapshot();
                     }
                     else if (clicks == 10) {
                         scenaraio = 2;
                         currentPage = 0;
-                        zoomFactor = 1.5;                    
+                        zoomFactor = PageRenderer::DEFAULT_ZOOM;                    
                         currentTaskIndex = 0;
                         pdfFiles.clear();
                         txtFiles.clear();
-                        scene->clear();
+                        clearPageScene();
                         document = nullptr;
+                        pageRenderer.close();
                         showFilesList(config.todo,".txt");
                         cameraThread->stopCapturing();
                     }                
@@ -1934,7 +1959,11 @@ void CameraViewer::handleIMUClassification(const QString& label) {
     if (operator_status_list.size() >= 4) {
         auto frequency = frequency_counter(operator_status_list);
 
-        if (frequency["Fall"] >= 3) {    
+        // A latched fall owns the status until it is retracted or cleared
+        if (fall_latched) {
+            LOG_INFO("Fall latched, classification vote ignored");
+        }
+        else if (frequency["Fall"] >= 3) {    
             session.set_operator_status("Fall");                      
         }
         else if (frequency["Relax"] >= 3) {
@@ -1953,6 +1982,35 @@ void CameraViewer::handleIMUClassification(const QString& label) {
     }
 }
 
+void CameraViewer::handleFallEvent(const FallEvent& event) {
+    if (event.phase == FallEvent::Provisional) {
+        LOG_WARN("Provisional fall, pushing status");
+        if (!fall_latched && session.get_operator_status() != "Fall")
+            status_before_fall = session.get_operator_status();
+        fall_latched = true;
+        session.set_operator_status("Fall");
+        session.push_status_now();
+    } else if (event.phase == FallEvent::Confirmed) {
+        LOG_INFO("Fall confirmed by the IMU classifier");
+        fall_latched = true;
+        session.set_operator_status("Fall");
+        session.push_status_now();
+    } else if (fall_latched) {
+        releaseFall("retracted by the IMU classifier");
+    }
+}
+
+// Ends a latched fall: back to the status from before it, and the classification votes drive the status again
+void CameraViewer::releaseFall(const std::string& reason) {
+    std::string status = status_before_fall.empty() ? "Work" : status_before_fall;
+    LOG_INFO("Fall " + reason + ", back to " + status);
+    fall_latched = false;
+    status_before_fall.clear();
+    operator_status_list.clear();
+    session.set_operator_status(status);
+    session.push_status_now();
+}
+
 void CameraViewer::complete_standalone_transition(bool _NOWIFI) {
     try {
         A_control.setCaptureInputVolume(0);
@@ -1970,6 +2028,9 @@ void CameraViewer::complete_standalone_transition(bool _NOWIFI) {
                 floatingMessage->showMessage(QString::fromStdString(config.download_file) , 3);
                 QtConcurrent::run([this](){
                     session.Download_standalone_FILES(); // Heavy blocking
+                    catalog.startIndexing(config.todo);
+                    searchIndex.startIndexing(config.todo);
+                    pageCache.warm(config.todo, PageRenderer::DEFAULT_ZOOM);
                     QMetaObject::invokeMethod(this, [this](){
                         floatingMessage->timer_stop(true);
                         floatingMessage->showMessage(QString::fromStdString(lang.getText("standalonetab","download")), 1);
@@ -2023,6 +2084,9 @@ void CameraViewer::complete_standalone_transition(bool _NOWIFI) {
         else{            
             current_mode = "Standalone";
             session.update_helmet_status(current_mode);
+            catalog.startIndexing(config.todo);
+            searchIndex.startIndexing(config.todo);
+            pageCache.warm(config.todo, PageRenderer::DEFAULT_ZOOM);
             floatingMessage->showMessage(QString::fromStdString(lang.getText("error_message","FILES")), 1);
             A_control.setCaptureInputType("ADC");
             A_control.setCaptureInputVolume(30);
@@ -2087,7 +2151,11 @@ std::string CameraViewer::getCurrentDateTime() {
 void CameraViewer::handle_command_recognize(std::string _command) {
     try {
         if (_command !="") {
+            // A recognized command means the operator is responsive again
+            if (fall_latched)
+                releaseFall("cleared by a voice command");
             _command = toUpperCase(_command);                   
+            std::string query;
             if (current_mode.find("Standalone") != std::string::npos) {                
                 floatingMessage->showMessage(QString::fromStdString(lang.getText("standalonetab","msgboxcommand") + _command));     
                 LOG_INFO("scenaraio  " + std::to_string(scenaraio));
@@ -2144,8 +2212,7 @@ void CameraViewer::handle_command_recognize(std::string _command) {
                     }
                     else if (_command == lang.getText("standalonetab","close")) {       
                         cameraThread->releasecamera();         
-                        if (pdf.getPageCount() > 2)
-                            pdf.saveToFile(lang.getText("pdf_message","name")+getCurrentDateTime()+".pdf");
+                        pdf.save(lang.getText("pdf_message","name")+getCurrentDateTime()+".pdf", 3);
                         if (config.debug == 0) {
                             network.enable_wifi();
                             int Wconnected = 2;
@@ -2231,6 +2298,10 @@ void CameraViewer::handle_command_recognize(std::string _command) {
                         mp4Files.clear();   
                         showdefaultstandalone();
                     }
+                    else if (searchQuery(_command, query)) {
+                        if (!openSearchHit(query, ".pdf"))
+                            LOG_INFO("No search hits for " + query);
+                    }
                 }
                 else if (scenaraio == 2) {
                     auto it = config.getNumberMappings().find(_command);
@@ -2269,6 +2340,10 @@ void CameraViewer::handle_command_recognize(std::string _command) {
                         mp4Files.clear();   
                         showdefaultstandalone();
                     }
+                    else if (searchQuery(_command, query)) {
+                        if (!openSearchHit(query, ".txt"))
+                            LOG_INFO("No search hits for " + query);
+                    }
                 }
                 else if (scenaraio == 3) {
                     auto it = config.getNumberMappings().find(_command);
@@ -2370,17 +2445,15 @@ void CameraViewer::handle_command_recognize(std::string _command) {
                     else if (_command == lang.getText("standalonetab","right"))
                         scrollRight();
                     else if (_command == lang.getText("standalonetab","snapshot")) {
-                        if (cameraThread->takeSnapshot(config.snapshot_file)) {
-                            pdf.addImage("/home/x_user/my_camera_project/snapshot.png");
-                            pdf.addText("------------------------------------------------");
-                        }
+                        reportSnapshot();
                     }
                     else if (_command == lang.getText("standalonetab","quit")) {
                         scenaraio = 1;
                         currentPage = 0;
-                        zoomFactor = 1.5;
-                        scene->clear();
+                        zoomFactor = PageRenderer::DEFAULT_ZOOM;
+                        clearPageScene();
                         document = nullptr;
+                        pageRenderer.close();
                         pdfFiles.clear();
                         showFilesList(config.todo,".pdf");                        
                         cameraThread->stopCapturing();
@@ -2389,6 +2462,10 @@ void CameraViewer::handle_command_recognize(std::string _command) {
                         QMetaObject::invokeMethod(helptimer, "start", Qt::QueuedConnection, Q_ARG(int, 5000));
                         stackedWidget->setCurrentIndex(1);
                     }            
+                    else if (searchQuery(_command, query)) {
+                        if (!openSearchHit(query, ".pdf"))
+                            LOG_INFO("No search hits for " + query);
+                    }
                 }
                 else if (scenaraio == 22) {
                     if (_command == lang.getText("standalonetab","next")) {
@@ -2398,15 +2475,12 @@ void CameraViewer::handle_command_recognize(std::string _command) {
                         prevTask();
                     }
                     else if (_command == lang.getText("standalonetab","snapshot")) {
-                        if (cameraThread->takeSnapshot(config.snapshot_file)) {
-                            pdf.addImage("/home/x_user/my_camera_project/snapshot.png");
-                            pdf.addText("------------------------------------------------");
-                        }
+                        reportSnapshot();
                     }
                     else if (_command == lang.getText("standalonetab","quit")) {
                         scenaraio = 2;
                         currentTaskIndex = 0;
-                        scene->clear();
+                        clearPageScene();
                         txtFiles.clear();
                         showFilesList(config.todo,".txt");
                         cameraThread->stopCapturing();
@@ -2444,20 +2518,18 @@ void CameraViewer::handle_command_recognize(std::string _command) {
                         scrollRight();
                     }
                     else if (_command == lang.getText("standalonetab","snapshot")) {
-                        if (cameraThread->takeSnapshot(config.snapshot_file)) {
-                            pdf.addImage("/home/x_user/my_camera_project/snapshot.png");
-                            pdf.addText("------------------------------------------------");
-                        }
+                        reportSnapshot();
                     }
                     else if (_command == lang.getText("standalonetab","quit")) {
                         scenaraio = 2;
                         currentPage = 0;
-                        zoomFactor = 1.5;                    
+                        zoomFactor = PageRenderer::DEFAULT_ZOOM;                    
                         currentTaskIndex = 0;
                         pdfFiles.clear();
                         txtFiles.clear();
-                        scene->clear();
+                        clearPageScene();
                         document = nullptr;
+                        pageRenderer.close();
                         showFilesList(config.todo,".txt");
                         cameraThread->stopCapturing();
                     }       
@@ -2968,6 +3040,7 @@ void CameraViewer::changeLanguage(std::string _lang) {
             // Instead of passing &newVoiceThread, use std::move capture
             QMetaObject::invokeMethod(this, [this, thread = std::move(newVoiceThread)]() mutable {
                 voiceThread = std::move(thread);
+                updateVoiceGrammar();
                 AudioReset();
                 voiceThread->start();
                 config.updateDefaultLanguage(lang.getDefaultLanguage());
@@ -3374,16 +3447,7 @@ void CameraViewer::showdefaultstandalone(bool _standalone) {
             }
             // Add the items to the QListWidget
             listFiles->addItems(navItems);         
-            QPixmap pixmap1 = this->grab();
-            pixmap1.scaled(640, 480, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-            pixmap1.save("/home/x_user/my_camera_project/screenshot.png", "PNG");
-            pdf.addImage("/home/x_user/my_camera_project/screenshot.png");
-            pdf.addText("------------------------------------------------");
-            // if (cameraThread->takeSnapshotGst(config.snapshot_pipeline))
-            if (cameraThread->takeSnapshot(config.snapshot_file)) {
-                pdf.addImage("/home/x_user/my_camera_project/snapshot.png");
-                pdf.addText("------------------------------------------------");
-            }
+            reportScreenshot();
         }
         else {            
             current_mode = "emptyStand"; 
@@ -3450,7 +3514,7 @@ void CameraViewer::showvideomode() {
     listvideos->addItems(navItems);
 }
 
-void CameraViewer::showFilesList(const std::string &folder_path, const std::string &suffix) {
+void CameraViewer::showFilesList(const std::string &folder_path, const std::string &suffix, bool _refresh) {
     try {        
         std::string files_type;
         if (suffix == ".mp4")
@@ -3459,45 +3523,85 @@ void CameraViewer::showFilesList(const std::string &folder_path, const std::stri
             files_type = lang.getText("standalonetab","document");
         else
             files_type = lang.getText("standalonetab","task");
-        pdf.addText(lang.getText("pdf_message","mode") + files_type + " - " + getCurrentDateTime());
+        if (!_refresh)
+            pdf.addText(lang.getText("pdf_message","mode") + files_type + " - " + getCurrentDateTime());
         listFiles->clear();
         taskListWidget->clear();
-        QDir dir(QString::fromStdString(folder_path));
-        dir.setNameFilters({ "*" + QString::fromStdString(suffix) });
-        QStringList files = dir.entryList(QDir::Files);
         int i = 1;          // Counter for item numbers
-        for (const QString &file : files) {
-            QString fullPath = dir.filePath(file);
-            if (suffix == ".pdf") {
-                pdfFiles.push_back(fullPath.toStdString());
-            } else if (suffix == ".txt") {
-                txtFiles.push_back(fullPath.toStdString());
+        if (catalog.covers(folder_path) && !catalog.isIndexing()) {
+            // Render from the catalog: no file is opened, broken files are left out
+            for (const FileCatalog::Entry &entry : catalog.list(suffix)) {
+                if (!entry.valid) {
+                    LOG_WARN("Skipping unreadable file " + entry.name);
+                    continue;
+                }
+                if (suffix == ".pdf") {
+                    pdfFiles.push_back(entry.path);
+                } else if (suffix == ".txt") {
+                    txtFiles.push_back(entry.path);
+                }
+                else if (suffix == ".mp4") {
+                    mp4Files.push_back(entry.path);
+                }
+                QString details;
+                if (suffix == ".mp4") {
+                    int seconds = static_cast<int>(entry.duration_ms / 1000);
+                    details = QString(" (%1:%2, %3x%4)").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0')).arg(entry.width).arg(entry.height);
+                } else {
+                    details = QString(" (%1)").arg(entry.pages);
+                }
+                QListWidgetItem *item = new QListWidgetItem(QString::number(i) + " - " + QString::fromStdString(entry.name) + details);
+                if (!entry.thumbnail.isEmpty()) {
+                    item->setIcon(QIcon(QPixmap::fromImage(QImage::fromData(entry.thumbnail, "JPEG"))));
+                }
+                listFiles->addItem(item);
+                i++;
             }
-            else if (suffix == ".mp4") {
-                mp4Files.push_back(fullPath.toStdString());
+        }
+        else {
+            QDir dir(QString::fromStdString(folder_path));
+            dir.setNameFilters({ "*" + QString::fromStdString(suffix) });
+            QStringList files = dir.entryList(QDir::Files);
+            for (const QString &file : files) {
+                QString fullPath = dir.filePath(file);
+                if (suffix == ".pdf") {
+                    pdfFiles.push_back(fullPath.toStdString());
+                } else if (suffix == ".txt") {
+                    txtFiles.push_back(fullPath.toStdString());
+                }
+                else if (suffix == ".mp4") {
+                    mp4Files.push_back(fullPath.toStdString());
+                }
+                // Add item to the QListWidget
+                listFiles->addItem(QString::number(i) + " - " + file);
+                i++;
             }
-            // Add item to the QListWidget
-            listFiles->addItem(QString::number(i) + " - " + file);
-            i++;
         }
         listFiles->addItem(QString::number(i) + QString::fromStdString(" - " + lang.getText("standalonetab","quit")));  
         stackedWidget->setCurrentIndex(1);
-        QPixmap pixmap1 = this->grab();
-        pixmap1.scaled(640, 480, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-        pixmap1.save("/home/x_user/my_camera_project/screenshot.png", "PNG");
-        pdf.addImage("/home/x_user/my_camera_project/screenshot.png");
-        pdf.addText("------------------------------------------------");
-        // if (cameraThread->takeSnapshotGst(config.snapshot_pipeline))
-        if (cameraThread->takeSnapshot(config.snapshot_file)) {
-            pdf.addImage("/home/x_user/my_camera_project/snapshot.png");
-            pdf.addText("------------------------------------------------");
-        }
+        if (!_refresh)
+            reportScreenshot();
     } catch (const std::exception& e) {
         LOG_ERROR("An error occurred in CameraViewer showFilesList: " + std::string(e.what()));
     }
 }
 
-void CameraViewer::LoadPDF(const std::string &full_path) {
+// A browser opened while the catalog was still indexing shows the plain directory listing; redraw it from the catalog
+void CameraViewer::handle_catalog_updated() {
+    try {
+        if (current_mode.find("Standalone") == std::string::npos || scenaraio < 1 || scenaraio > 3)
+            return;
+        static const char* suffixes[] = {".pdf", ".txt", ".mp4"};
+        pdfFiles.clear();
+        txtFiles.clear();
+        mp4Files.clear();
+        showFilesList(config.todo, suffixes[scenaraio - 1], true);
+    } catch (const std::exception& e) {
+        LOG_ERROR("An error occurred in CameraViewer handle_catalog_updated: " + std::string(e.what()));
+    }
+}
+
+void CameraViewer::LoadPDF(const std::string &full_path, int start_page) {
     try {
         // Extract file name using std::filesystem
         std::filesystem::path path_obj(full_path);
@@ -3515,12 +3619,15 @@ void CameraViewer::LoadPDF(const std::string &full_path) {
             }
             return;
         }        
-        currentPage = 0;
+        current_pdf_path = full_path;
+        currentPage = std::min(std::max(start_page, 0), document->numPages() - 1);
         cameraThread->startCapturing(config.period);
+        pdf.addPageBreak();
         pdf.addText(lang.getText("pdf_message","pdf") + filename + " - " + getCurrentDateTime());
         stackedWidget->setCurrentIndex(2);
         document->setRenderHint(Poppler::Document::Antialiasing);
         document->setRenderHint(Poppler::Document::TextAntialiasing);
+        pageRenderer.open(full_path);
         showPage(currentPage);
     } catch (const std::exception& e) {
         LOG_ERROR("An error occurred in CameraViewer LoadPDF: " + std::string(e.what()));
@@ -3547,6 +3654,7 @@ void CameraViewer::LoadMP4(const std::string &full_path) {
         videoThread->update_video_path(full_path);
         int _vid = videoThread->init();
         if (_vid == 0) {
+            pdf.addPageBreak();
             pdf.addText(lang.getText("pdf_message","mp4")  + filename + " - " + getCurrentDateTime());
             stackedWidget->setCurrentIndex(3);
             listFiles->clear();
@@ -3574,16 +3682,7 @@ void CameraViewer::LoadMP4(const std::string &full_path) {
             // Add the items to the QListWidget
             listFiles->addItems(navItems);
             listvideos->addItems(navItems);
-            QPixmap pixmap1 = this->grab();
-            pixmap1.scaled(640, 480, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-            pixmap1.save("/home/x_user/my_camera_project/screenshot.png", "PNG");
-            pdf.addImage("/home/x_user/my_camera_project/screenshot.png");
-            pdf.addText("------------------------------------------------");            
-            // if (cameraThread->takeSnapshotGst(config.snapshot_pipeline))
-            if (cameraThread->takeSnapshot(config.snapshot_file)) {
-                pdf.addImage("/home/x_user/my_camera_project/snapshot.png");
-                pdf.addText("------------------------------------------------");
-            }
+            reportScreenshot();
         }
         else {
             floatingMessage->showMessage(QString::fromStdString(lang.getText("standalonetab","NOVIDEO")), 2); 
@@ -3614,6 +3713,7 @@ std::string CameraViewer::loadTasks(const std::string &full_path) {
         // Extract file name using std::filesystem
         std::filesystem::path path_obj(full_path);
         std::string filename = path_obj.filename().string();
+        pdf.addPageBreak();
         pdf.addText(lang.getText("pdf_message","txt") + filename + " - " + getCurrentDateTime());
         std::ifstream file(full_path);
         std::string line;
@@ -3648,6 +3748,9 @@ std::string CameraViewer::loadTasks(const std::string &full_path) {
 
 void CameraViewer::displayTasks() {
     try {        
+        // Keyed on the task text too: task N of another task file is a different screen
+        bool has_task = currentTaskIndex >= 0 && currentTaskIndex < static_cast<int>(tasks.size());
+        pdf.setView("task#" + std::to_string(currentTaskIndex) + " " + (has_task ? tasks[currentTaskIndex] : ""));
         pdf.addText(lang.getText("pdf_message","taskN")  + std::to_string(currentTaskIndex + 1) +  " - " + getCurrentDateTime());        
         taskListWidget->clear();
         // Ensure up to 3 tasks are displayed, including the current one
@@ -3670,16 +3773,7 @@ void CameraViewer::displayTasks() {
                 item->setFont(QFont(item->font().family(), item->font().pointSize(), QFont::Bold));  
             }
         }
-        QPixmap pixmap1 = this->grab();
-        pixmap1.scaled(640, 480, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-        pixmap1.save("/home/x_user/my_camera_project/screenshot.png", "PNG");
-        pdf.addImage("/home/x_user/my_camera_project/screenshot.png");
-        pdf.addText("------------------------------------------------");        
-        // if (cameraThread->takeSnapshotGst(config.snapshot_pipeline))
-        if (cameraThread->takeSnapshot(config.snapshot_file)) {
-            pdf.addImage("/home/x_user/my_camera_project/snapshot.png");
-            pdf.addText("------------------------------------------------");
-        }
+        reportScreenshot();
     } catch (const std::exception& e) {
         LOG_ERROR("An error occurred in CameraViewer displayTasks: " + std::string(e.what()));
     }
@@ -3709,6 +3803,120 @@ void CameraViewer::loadTXT(const std::string &full_path) {
     }  
 }
 
+void CameraViewer::reportSnapshot() {
+    try {
+        cv::Mat snapshot;
+        if (cameraThread->takeSnapshot(snapshot)) {
+            pdf.addImage(snapshot);
+            pdf.addText("------------------------------------------------");
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("An error occurred in CameraViewer reportSnapshot: " + std::string(e.what()));
+    }
+}
+
+void CameraViewer::reportScreenshot() {
+    try {
+        // Downscaled and encoded on the report writer thread
+        pdf.addImage(this->grab().toImage());
+        pdf.addText("------------------------------------------------");
+    } catch (const std::exception& e) {
+        LOG_ERROR("An error occurred in CameraViewer reportScreenshot: " + std::string(e.what()));
+    }
+    reportSnapshot();
+}
+
+// Document text is only reachable through "search <term>": the recognizer grammar holds the command words plus
+// one such phrase per distinctive index term of the current language (see updateVoiceGrammar)
+bool CameraViewer::searchQuery(const std::string &_command, std::string &_query) {
+    std::string prefix = lang.getText("standalonetab","search") + " ";
+    if (_command.compare(0, prefix.size(), prefix) != 0)
+        return false;
+    _query = _command.substr(prefix.size());
+    // Numbers and part numbers are spoken digit by digit; search for the indexed term
+    auto spoken = voice_search_terms.find(_query);
+    if (spoken != voice_search_terms.end())
+        _query = spoken->second;
+    return !_query.empty();
+}
+
+// A term as the recognizer hears it: digits become the language's digit words, e.g. "ab12" -> "ab one two"
+std::string CameraViewer::spokenTerm(const std::string &term, const std::vector<std::string> &digits) {
+    std::string spoken;
+    bool in_word = false;
+    for (char c : term) {
+        bool digit = c >= '0' && c <= '9';
+        if (digit && digits.size() != 10)
+            return "";
+        if (!spoken.empty() && (digit || !in_word))
+            spoken += ' ';
+        if (digit)
+            spoken += digits[c - '0'];
+        else
+            spoken += c;
+        in_word = !digit;
+    }
+    return spoken;
+}
+
+void CameraViewer::updateVoiceGrammar() {
+    try {
+        if (!voiceThread)
+            return;
+        QString search = QString::fromStdString(lang.getText("standalonetab","search")).toLower();
+        std::vector<std::string> digits = lang.getList("digits");
+        std::vector<std::string> phrases;
+        voice_search_terms.clear();
+        for (const std::string &term : searchIndex.vocabulary(search.toStdString(), VOICE_SEARCH_TERMS)) {
+            std::string spoken = spokenTerm(term, digits);
+            if (spoken.empty())
+                continue;
+            phrases.push_back(search.toStdString() + " " + spoken);
+            if (spoken != term)
+                voice_search_terms[toUpperCase(spoken)] = term;
+        }
+        voiceThread->setGrammar(lang.getGrammar(phrases));
+        LOG_INFO("Voice grammar has " + std::to_string(phrases.size()) + " search phrases");
+    } catch (const std::exception& e) {
+        LOG_ERROR("An error occurred in CameraViewer updateVoiceGrammar: " + std::string(e.what()));
+    }
+}
+
+bool CameraViewer::openSearchHit(const std::string &_query, const std::string &suffix) {
+    try {
+        std::vector<TextSearchIndex::Hit> hits = searchIndex.query(_query, suffix, document ? current_pdf_path : "");
+        if (hits.empty())
+            return false;
+        const TextSearchIndex::Hit &hit = hits.front();
+        LOG_INFO("Search " + _query + " -> " + hit.name + " " + std::to_string(hit.page + 1));
+        if (suffix == ".pdf") {
+            if (document && hit.path == current_pdf_path) {
+                currentPage = hit.page;
+                showPage(currentPage);
+                return true;
+            }
+            if (document) {
+                clearPageScene();
+                delete document;
+                document = nullptr;
+            }
+            scenaraio = 11;
+            showpdfmode();
+            LoadPDF(hit.path, hit.page);
+        }
+        else {
+            scenaraio = 22;
+            currentTaskIndex = hit.page;
+            showtxtmode();
+            loadTXT(hit.path);
+        }
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR("An error occurred in CameraViewer openSearchHit: " + std::string(e.what()));
+        return false;
+    }
+}
+
 void CameraViewer::showPage(int page_num) {
     try {
         if (!document || page_num < 0 || page_num >= document->numPages()) {
@@ -3725,8 +3933,16 @@ void CameraViewer::showPage(int page_num) {
             showFilesList(config.todo,".pdf");
             return;
         }
-        // Render the page to an image
-        QImage image = page->renderToImage(zoomFactor * 72.0, zoomFactor * 72.0);
+        // Large pages are shown as a low resolution preview with tiles rendered over the visible area
+        bool tiled = PageRenderer::needsTiles(page, zoomFactor);
+        float render_zoom = tiled ? PageRenderer::PREVIEW_ZOOM : zoomFactor;
+        // Use the cached render if there is one, otherwise show a low resolution placeholder until the worker delivers
+        QImage image;
+        bool rendered = pageRenderer.cached(page_num, render_zoom, image) || pageRenderer.cachedOnDisk(page_num, render_zoom, image);
+        if (!rendered) {
+            image = PageRenderer::placeholder(page, render_zoom);
+            pageRenderer.request(page_num, render_zoom);
+        }
         if (image.isNull()) {
             LOG_ERROR("Failed to render page: " + std::to_string(page_num));
             scenaraio = 1;
@@ -3734,29 +3950,134 @@ void CameraViewer::showPage(int page_num) {
             delete page;
             return;
         }
+        pdf.setView(current_pdf_path + "#" + std::to_string(page_num));
         pdf.addText(lang.getText("pdf_message","pageN") + std::to_string(currentPage + 1) +  " - " + getCurrentDateTime());
-        // Convert the image to a pixmap and add it to the scene
-        QPixmap pixmap = QPixmap::fromImage(image);
-        scene->clear();
-        scene->addPixmap(pixmap);
-        scene->setSceneRect(pixmap.rect());
+        if (tiled) {
+            QSizeF points = page->pageSizeF();
+            showTiledPage(image, QSize(static_cast<int>(points.width() * zoomFactor), static_cast<int>(points.height() * zoomFactor)));
+        }
+        else
+            displayPageImage(image);
         // Clean up
         delete page;
-        QPixmap pixmap1 = this->grab();
-        pixmap1.scaled(640, 480, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-        pixmap1.save("/home/x_user/my_camera_project/screenshot.png", "PNG");
-        pdf.addImage("/home/x_user/my_camera_project/screenshot.png");
-        pdf.addText("------------------------------------------------");
-        // if (cameraThread->takeSnapshotGst(config.snapshot_pipeline))
-        if (cameraThread->takeSnapshot(config.snapshot_file)) {
-            pdf.addImage("/home/x_user/my_camera_project/snapshot.png");
-            pdf.addText("------------------------------------------------");
-        }
+        // Warm the neighbours so the next page turn is served from the cache
+        if (page_num + 1 < document->numPages())
+            pageRenderer.prefetch(page_num + 1, render_zoom);
+        if (page_num > 0)
+            pageRenderer.prefetch(page_num - 1, render_zoom);
+        // The report gets the page, not the placeholder: without a cached render the screenshot waits for the worker
+        page_report_pending = !rendered;
+        if (rendered)
+            reportScreenshot();
     } catch (const std::exception& e) {
         LOG_ERROR("An error occurred in CameraViewer showPage: " + std::string(e.what()));
     }   
 }
 
+void CameraViewer::displayPageImage(const QImage& page_image) {
+    // Convert the image to a pixmap and add it to the scene
+    QPixmap page_pixmap = QPixmap::fromImage(page_image);
+    clearPageScene();
+    scene->addPixmap(page_pixmap);
+    scene->setSceneRect(page_pixmap.rect());
+}
+
+void CameraViewer::showTiledPage(const QImage& preview, const QSize& full_size) {
+    clearPageScene();
+    tiled_page = true;
+    tiled_page_size = full_size;
+    // The preview is stretched to the full page size and stays underneath while tiles fill in
+    previewItem = scene->addPixmap(QPixmap::fromImage(preview));
+    previewItem->setScale(static_cast<double>(full_size.width()) / std::max(1, preview.width()));
+    scene->setSceneRect(0, 0, full_size.width(), full_size.height());
+    updateTiles();
+}
+
+void CameraViewer::handle_page_rendered(uint64_t _generation, int _page, float _zoom, const QRect& _region, const QImage& _image) {
+    // Only replace placeholders if the operator is still on that page and zoom of the same document: a render queued
+    // before LoadPDF switched documents arrives afterwards with the previous generation
+    if (!document || _generation != pageRenderer.currentGeneration() || _page != currentPage)
+        return;
+    if (!_region.isEmpty()) {
+        if (tiled_page && _zoom == zoomFactor)
+            addTile(_region, _image);
+    }
+    else if (tiled_page) {
+        if (_zoom == PageRenderer::PREVIEW_ZOOM && previewItem) {
+            previewItem->setPixmap(QPixmap::fromImage(_image));
+            previewItem->setScale(static_cast<double>(tiled_page_size.width()) / std::max(1, _image.width()));
+            reportPendingPage();
+        }
+    }
+    else if (_zoom == zoomFactor) {
+        displayPageImage(_image);
+        reportPendingPage();
+    }
+}
+
+void CameraViewer::reportPendingPage() {
+    if (!page_report_pending)
+        return;
+    page_report_pending = false;
+    reportScreenshot();
+}
+
+void CameraViewer::addTile(const QRect& region, const QImage& tile) {
+    std::pair<int, int> key(region.x() / PageRenderer::TILE_SIZE, region.y() / PageRenderer::TILE_SIZE);
+    // Tiles that scrolled out of range while rendering are dropped to keep memory bounded
+    if (tileItems.count(key) || !tile_range.contains(key.first, key.second))
+        return;
+    QGraphicsPixmapItem *item = scene->addPixmap(QPixmap::fromImage(tile));
+    item->setPos(region.x(), region.y());
+    item->setZValue(1);
+    tileItems[key] = item;
+}
+
+void CameraViewer::updateTiles() {
+    if (!tiled_page || !document)
+        return;
+    const int tile = PageRenderer::TILE_SIZE;
+    QRect visible = view->mapToScene(view->viewport()->rect()).boundingRect().toAlignedRect();
+    QRect wanted = visible.adjusted(-tile, -tile, tile, tile).intersected(QRect(QPoint(0, 0), tiled_page_size));
+    if (wanted.isEmpty())
+        return;
+    tile_range = QRect(QPoint(wanted.left() / tile, wanted.top() / tile), QPoint(wanted.right() / tile, wanted.bottom() / tile));
+    for (auto it = tileItems.begin(); it != tileItems.end();) {
+        if (tile_range.contains(it->first.first, it->first.second)) {
+            ++it;
+            continue;
+        }
+        scene->removeItem(it->second);
+        delete it->second;
+        it = tileItems.erase(it);
+    }
+    // Jobs for tiles that are no longer wanted are dropped, the visible ones go first
+    pageRenderer.cancelTiles();
+    for (int row = tile_range.top(); row <= tile_range.bottom(); ++row) {
+        for (int col = tile_range.left(); col <= tile_range.right(); ++col) {
+            if (tileItems.count({col, row}))
+                continue;
+            QRect region(col * tile, row * tile,
+                         std::min(tile, tiled_page_size.width() - col * tile),
+                         std::min(tile, tiled_page_size.height() - row * tile));
+            QImage tile_image;
+            if (pageRenderer.cached(currentPage, zoomFactor, tile_image, region))
+                addTile(region, tile_image);
+            else if (visible.intersects(region))
+                pageRenderer.request(currentPage, zoomFactor, region);
+            else
+                pageRenderer.prefetch(currentPage, zoomFactor, region);
+        }
+    }
+}
+
+void CameraViewer::clearPageScene() {
+    scene->clear();
+    tileItems.clear();
+    previewItem = nullptr;
+    tiled_page = false;
+}
+
 void CameraViewer::nextPage() {
     if (document && currentPage < document->numPages() - 1) {
         ++currentPage;
@@ -3789,6 +4110,7 @@ void CameraViewer::scrollUp() {
         // Calculate 30% of the visible height
         int scrollAmount = static_cast<int>(visibleHeight * 0.3);
         view->verticalScrollBar()->setValue(view->verticalScrollBar()->value() - scrollAmount);
+        updateTiles();
     }
 }
 
@@ -3798,6 +4120,7 @@ void CameraViewer::scrollDown() {
         // Calculate 30% of the visible height
         int scrollAmount = static_cast<int>(visibleHeight * 0.3);
         view->verticalScrollBar()->setValue(view->verticalScrollBar()->value() + scrollAmount);
+        updateTiles();
     }
 }
 
@@ -3807,6 +4130,7 @@ void CameraViewer::scrollLeft() {
         // Calculate 30% of the visible width
         int scrollAmount = static_cast<int>(visibleWidth * 0.3);
         view->horizontalScrollBar()->setValue(view->horizontalScrollBar()->value() - scrollAmount);
+        updateTiles();
     }
 }
 
@@ -3816,6 +4140,7 @@ void CameraViewer::scrollRight() {
         // Calculate 30% of the visible width
         int scrollAmount = static_cast<int>(visibleWidth * 0.3);
         view->horizontalScrollBar()->setValue(view->horizontalScrollBar()->value() + scrollAmount);
+        updateTiles();
     }
 }
 
@@ -4082,7 +4407,7 @@ std::string CameraViewer::removePadding(const std::string &input, const std::str
 // QR Code Processing
 void CameraViewer::processQRCode(cv::Mat _frame){
     try {
-        LOG_INFO("processQRCode");
+        LOG_DEBUG("processQRCode");
         cv::Point top_left1(337, 57);
         cv::Point bottom_right1(942, 662);
         cv::resize(_frame, resized_image, cv::Size(490, 490), 0, 0, cv::INTER_LINEAR);
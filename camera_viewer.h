@@ -59,11 +59,15 @@
 #include "camerareader.h"
 #include "speechThread.h"
 #include "power_management.h"
-#include "PDFCreator.h"
+#include "ReportWriter.h"
 #include "videocontroller.h"
 #include "LanguageManager.h"
 #include "FloatingMessage.h"
 #include "imu_classifier_thread.h" 
+#include "FileCatalog.h"
+#include "TextSearchIndex.h"
+#include "DiskPageCache.h"
+#include "PageRenderer.h"
 
 #include <algorithm> // For std::sort
 #include <map>
@@ -109,13 +113,27 @@ public:
     void showpdfmode();
     void showvideomode();
     void showtxtmode();
-    void showFilesList(const std::string &folder_path, const std::string &suffix);
-    void LoadPDF(const std::string &filepath);
+    void showFilesList(const std::string &folder_path, const std::string &suffix, bool _refresh = false);
+    void handle_catalog_updated();
+    void LoadPDF(const std::string &filepath, int start_page = 0);
     void LoadMP4(const std::string &filepath);
     std::string loadTasks(const std::string &filename);
     void displayTasks();
     void loadTXT(const std::string &filePath);
+    void reportScreenshot();
+    void reportSnapshot();
+    bool searchQuery(const std::string &_command, std::string &_query);
+    void updateVoiceGrammar();
+    static std::string spokenTerm(const std::string &term, const std::vector<std::string> &digits);
+    bool openSearchHit(const std::string &_query, const std::string &suffix);
     void showPage(int pageNum);
+    void displayPageImage(const QImage& page_image);
+    void showTiledPage(const QImage& preview, const QSize& full_size);
+    void handle_page_rendered(uint64_t _generation, int _page, float _zoom, const QRect& _region, const QImage& _image);
+    void reportPendingPage();
+    void addTile(const QRect& region, const QImage& tile);
+    void updateTiles();
+    void clearPageScene();
     void nextPage();
     void previousPage();
     void zoomIn();
@@ -138,6 +156,7 @@ public:
     void processQRCode(cv::Mat _frame);
     void batteryiconchange(PowerManagement::BatteryStatus _status);
     void complete_standalone_transition(bool _NOWIFI);
+    void releaseFall(const std::string& reason);
     QHBoxLayout* createSliderControl(const QString &name, int min, int max, int value, QSlider*& slider);
     QHBoxLayout* createComboControl(const QString &name, const QString &items);
     void AudioReset();
@@ -150,6 +169,7 @@ private slots:
     void finish_helping();
     void checkwifi();
     void handleIMUClassification(const QString& label);
+    void handleFallEvent(const FallEvent& event);
 
 private:
     QGraphicsScene *videoScene, *videoScene1, *videoScene2;
@@ -204,7 +224,13 @@ private:
     zbar::ImageScanner scanner;
     QPixmap pixmap, pixmap1;
     QImage image;
-    PDFCreator pdf;
+    ReportWriter pdf;
+    FileCatalog catalog;
+    TextSearchIndex searchIndex;
+    static constexpr size_t VOICE_SEARCH_TERMS = 200;   // "search <term>" phrases added to the recognizer grammar
+    std::map<std::string, std::string> voice_search_terms;   // spoken form (as recognized) -> index term, for numbers
+    DiskPageCache pageCache;
+    PageRenderer pageRenderer;
     std::vector<std::string> pdfFiles;
     std::vector<std::string> txtFiles;
     std::vector<std::string> mp4Files;
@@ -221,6 +247,8 @@ private:
     QSlider *captureSlider;
     QLabel *captureInputLabel;
     std::vector<std::string> operator_status_list;
+    std::string status_before_fall;    // restored when the fall is retracted or cleared
+    bool fall_latched = false;         // a provisional or confirmed fall holds "Fall" against the classification votes
     std::string operator_status = "Unknown";
     const std::string QR_CODE_KEY = "mZq4t7w!z%C*F-Ja";
     const std::string QR_CODE_PADDING = "A";
@@ -234,8 +262,15 @@ private:
     int currentTaskIndex = 0;
     bool _pause_stream = false;
     int scenaraio = 0;
-    float zoomFactor = 1.5;
+    float zoomFactor = PageRenderer::DEFAULT_ZOOM;
     int currentPage = 0;
+    std::string current_pdf_path;
+    bool page_report_pending = false;  // page shown as a placeholder, screenshot taken when the render arrives
+    bool tiled_page = false;
+    QSize tiled_page_size;
+    QRect tile_range;                 // wanted tiles in tile units, visible area plus one tile of margin
+    QGraphicsPixmapItem *previewItem = nullptr;
+    std::map<std::pair<int, int>, QGraphicsPixmapItem*> tileItems;
     int _working_wifi = 0;
     std::string current_mode = "offline";
     int clicks = 0;
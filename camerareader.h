@@ -62,7 +62,7 @@ public:
 
     void startCapturing(int _period) {
         period =_period;
-        timer.start(period, 0, [this]() { CaptureFrame(); });
+        timer.start(period, [this]() { CaptureFrame(); });
     }
 
     void stopCapturing() {
@@ -209,9 +209,29 @@ public:
         }
     }
 
+    // Current frame as a 640x480 BGR image in memory, for the session report
+    bool takeSnapshot(cv::Mat& snapshot) {
+        try{
+            LOG_INFO("takeSnapshot");
+            if (frame.empty())
+                return false;
+            if (frame.channels() == 2) {
+                cvtColor(frame, snapshot, cv::COLOR_YUV2BGR_YUY2);
+                cv::resize(snapshot, snapshot, cv::Size(640,480), 0, 0, cv::INTER_NEAREST);
+            }
+            else {
+                cv::resize(frame, snapshot, cv::Size(640,480), 0, 0, cv::INTER_NEAREST);
+            }
+            return true;
+        } catch (const std::exception& e) {
+            LOG_ERROR("An error occurred in Camerareader takeSnapshot: " + std::string(e.what()));
+            return false;
+        }
+    }
+
 private:
     std::string camera_pipeline;
-    Timer timer;
+    Timer timer{"media", "capture"};    // shared with Videocontroller; capture and playback never run together
     cv::VideoCapture cap;
     cv::VideoWriter scap;
     cv::VideoCapture rcap;
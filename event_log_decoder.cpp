@@ -0,0 +1,183 @@
+// Decoder for the binary event log written by Logger in "log_format": "binary" mode (see EventLog.h)
+// g++ -std=c++17 -O2 -o event_log_decoder event_log_decoder.cpp
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <ctime>
+#include <cstring>
+#include "EventLog.h"
+
+static const char* LEVEL_NAMES[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+
+struct Filter {
+    std::string module;
+    int min_level = 0;
+    int64_t since = INT64_MIN;
+    int64_t until = INT64_MAX;
+};
+
+// Module name used by Logger level overrides: file name without directory and extension
+std::string moduleOf(const std::string& file) {
+    std::string module = file.substr(file.find_last_of('/') + 1);
+    return module.substr(0, module.find('.'));
+}
+
+std::string fieldText(const eventlog::Field& field) {
+    switch (field.type) {
+        case eventlog::INT: return std::to_string(field.i);
+        case eventlog::UINT: return std::to_string(field.u);
+        case eventlog::DOUBLE: return std::to_string(field.d);
+        case eventlog::BOOL: return field.u ? "true" : "false";
+        default: return field.s;
+    }
+}
+
+std::string formatMessage(const eventlog::Event& event) {
+    std::string out;
+    const std::string& pattern = event.site->pattern;
+    size_t pos = 0;
+    for (const auto& field : event.fields) {
+        size_t hole = pattern.find("{}", pos);
+        if (hole == std::string::npos)
+            break;
+        out.append(pattern, pos, hole - pos);
+        out += fieldText(field);
+        pos = hole + 2;
+    }
+    out.append(pattern, pos, std::string::npos);
+    return out;
+}
+
+std::string timeText(int64_t us) {
+    std::time_t seconds = static_cast<std::time_t>(us / 1000000);
+    std::tm local_tm;
+    localtime_r(&seconds, &local_tm);
+    char buffer[40];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local_tm);
+    char ms[8];
+    std::snprintf(ms, sizeof(ms), ".%03d", static_cast<int>((us / 1000) % 1000));
+    return std::string(buffer) + ms;
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out;
+}
+
+// "YYYY-mm-dd HH:MM:SS" local time to microseconds since epoch
+bool parseTime(const char* text, int64_t& us) {
+    std::tm tm = {};
+    if (!strptime(text, "%Y-%m-%d %H:%M:%S", &tm))
+        return false;
+    tm.tm_isdst = -1;
+    us = static_cast<int64_t>(std::mktime(&tm)) * 1000000;
+    return true;
+}
+
+int levelOf(const std::string& name) {
+    for (int i = 0; i < 4; ++i)
+        if (name == LEVEL_NAMES[i])
+            return i;
+    return -1;
+}
+
+void printEvent(const eventlog::Event& event, bool json) {
+    const eventlog::Site& site = *event.site;
+    const char* level = LEVEL_NAMES[std::min(std::max(site.level, 0), 3)];
+    std::string message = formatMessage(event);
+    if (!json) {
+        std::cout << "[" << timeText(event.stamp) << "] [" << level << "] [" << site.file << ":" << site.function << ":"
+                  << site.line << "] " << message << "\n";
+        return;
+    }
+    std::cout << "{\"time\":\"" << timeText(event.stamp) << "\",\"us\":" << event.stamp << ",\"level\":\"" << level
+              << "\",\"module\":\"" << jsonEscape(moduleOf(site.file)) << "\",\"file\":\"" << jsonEscape(site.file)
+              << "\",\"function\":\"" << jsonEscape(site.function) << "\",\"line\":" << site.line << ",\"thread\":" << event.thread
+              << ",\"message\":\"" << jsonEscape(message) << "\",\"fields\":[";
+    for (size_t i = 0; i < event.fields.size(); ++i) {
+        const auto& field = event.fields[i];
+        if (i)
+            std::cout << ",";
+        if (field.type == eventlog::STRING)
+            std::cout << "\"" << jsonEscape(field.s) << "\"";
+        else
+            std::cout << fieldText(field);
+    }
+    std::cout << "]}\n";
+}
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    Filter filter;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "--module" && has_value) {
+            filter.module = argv[++i];
+        } else if (arg == "--level" && has_value) {
+            filter.min_level = levelOf(argv[++i]);
+            if (filter.min_level < 0) {
+                std::cerr << "Unknown level " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if ((arg == "--since" || arg == "--until") && has_value) {
+            if (!parseTime(argv[++i], arg == "--since" ? filter.since : filter.until)) {
+                std::cerr << "Bad time " << argv[i] << ", expected \"YYYY-mm-dd HH:MM:SS\"" << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind("--", 0) == 0) {
+            files.clear();
+            break;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--json] [--module NAME] [--level DEBUG|INFO|WARN|ERROR]"
+                  << " [--since \"YYYY-mm-dd HH:MM:SS\"] [--until \"YYYY-mm-dd HH:MM:SS\"] <events.bin>..." << std::endl;
+        return 1;
+    }
+
+    int status = 0;
+    for (const auto& path : files) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cerr << "Error: Could not open file " << path << std::endl;
+            status = 1;
+            continue;
+        }
+        eventlog::Reader reader(std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>()));
+        if (!reader.isValid()) {
+            std::cerr << "Error: " << path << " is not an event log" << std::endl;
+            status = 1;
+            continue;
+        }
+        eventlog::Event event;
+        while (reader.next(event)) {
+            if (event.site->level < filter.min_level || event.stamp < filter.since || event.stamp > filter.until)
+                continue;
+            if (!filter.module.empty() && moduleOf(event.site->file) != filter.module)
+                continue;
+            printEvent(event, json);
+        }
+    }
+    return status;
+}
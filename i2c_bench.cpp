@@ -0,0 +1,112 @@
+// Counts I2C transactions and kernel calls per accelerometer sample on the replay bus (ReplayI2CBus, see I2CBus.h):
+// six single-register reads per sample as read_accel did (a write() and a read() each), one 6-byte burst per sample,
+// and the FIFO drain IMUClassifierThread runs every fifo_drain_ms (level register plus one burst, one I2C_RDWR each).
+// The replay file is a raw capture of the OUT_X_L..OUT_Z_H block (imu.i2c_replay_file).
+// g++ -std=c++17 -O2 -o i2c_bench i2c_bench.cpp -lpthread
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include "I2CBus.h"
+
+// LIS2DW12 registers, as in configuration_ap.json
+static const uint8_t WHO_AM_I = 0x0F;
+static const uint8_t OUT_X_L = 0x28;
+static const uint8_t FIFO_SAMPLES = 0x2F;
+static const uint8_t LIS2DW12_ID = 0x44;
+static const size_t FIFO_DEPTH = 32;
+static const uint8_t FIFO_SAMPLES_OVR = 0x40;
+static const uint8_t FIFO_SAMPLES_DIFF = 0x3F;
+
+static void report(const char* name, uint64_t transactions, uint64_t syscalls, uint64_t samples, uint64_t drains) {
+    std::printf("%-13s %8llu samples  %6.2f transactions/sample  %6.2f syscalls/sample", name,
+                static_cast<unsigned long long>(samples), samples ? static_cast<double>(transactions) / samples : 0.0,
+                samples ? static_cast<double>(syscalls) / samples : 0.0);
+    if (drains)
+        std::printf("  %6.2f transactions/drain, %.1f samples/drain", static_cast<double>(transactions) / drains,
+                    static_cast<double>(samples) / drains);
+    std::printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    int odr_hz = 200;
+    int drain_ms = 100;
+    double seconds = 5.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--odr" && has_value) {
+            odr_hz = std::stoi(argv[++i]);
+        } else if (arg == "--drain-ms" && has_value) {
+            drain_ms = std::stoi(argv[++i]);
+        } else if (arg == "--seconds" && has_value) {
+            seconds = std::stod(argv[++i]);
+        } else if (arg.rfind("--", 0) == 0 || !path.empty()) {
+            path.clear();
+            break;
+        } else {
+            path = arg;
+        }
+    }
+    if (path.empty() || odr_hz <= 0 || drain_ms <= 0 || seconds <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [--odr 200] [--drain-ms 100] [--seconds 5] <replay file>" << std::endl;
+        return 1;
+    }
+
+    uint64_t samples = static_cast<uint64_t>(seconds * odr_hz);
+    uint8_t raw[FIFO_DEPTH * 6];
+
+    // Per register: OUT_X_L, OUT_X_H, ... one transaction each
+    {
+        ReplayI2CBus bus(path, OUT_X_L, WHO_AM_I, LIS2DW12_ID);
+        if (!bus.open())
+            return 1;
+        for (uint64_t s = 0; s < samples; ++s)
+            for (uint8_t reg = OUT_X_L; reg < OUT_X_L + 6; ++reg)
+                bus.readReg(reg);
+        report("per-register", bus.transfers(), bus.transfers() * 2, samples, 0);
+    }
+
+    // Burst: the six output registers in one auto-incremented read
+    {
+        ReplayI2CBus bus(path, OUT_X_L, WHO_AM_I, LIS2DW12_ID);
+        if (!bus.open())
+            return 1;
+        for (uint64_t s = 0; s < samples; ++s)
+            bus.readRegs(OUT_X_L, raw, 6);
+        report("burst", bus.transfers(), bus.transfers(), samples, 0);
+    }
+
+    // FIFO drain in real time, as IMUClassifierThread::drainFifo reads it
+    {
+        ReplayI2CBus bus(path, OUT_X_L, WHO_AM_I, LIS2DW12_ID);
+        if (!bus.open())
+            return 1;
+        bus.emulateFifo(FIFO_SAMPLES, odr_hz, 6, FIFO_DEPTH);
+        uint64_t drained = 0, drains = 0, overruns = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto next = start;
+        while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds) {
+            next += std::chrono::milliseconds(drain_ms);
+            std::this_thread::sleep_until(next);
+            ++drains;
+            int level = bus.readReg(FIFO_SAMPLES);
+            if (level < 0)
+                continue;
+            if (level & FIFO_SAMPLES_OVR)
+                ++overruns;
+            size_t count = std::min<size_t>(level & FIFO_SAMPLES_DIFF, FIFO_DEPTH);
+            if (count > 0 && bus.readRegs(OUT_X_L, raw, count * 6))
+                drained += count;
+        }
+        report("fifo drain", bus.transfers(), bus.transfers(), drained, drains);
+        if (overruns)
+            std::printf("  %llu FIFO overruns: %d ms drains hold more than %zu samples at %d Hz\n",
+                        static_cast<unsigned long long>(overruns), drain_ms, FIFO_DEPTH, odr_hz);
+    }
+    Logger::flush();
+    return 0;
+}
@@ -10,292 +10,395 @@
 #include <functional>
 #include <onnxruntime_cxx_api.h>
 #include <optional>
+#include <memory>
+#include <thread>
+#include <chrono>
 #include "Configuration.h"
 #include "Timer.h"
-// Linux I2C stuff
-#include <fcntl.h>
-#include <unistd.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
+#include "I2CBus.h"
+#include "IMUSampleRing.h"
+#include "IMUFeatures.h"
+#include "IMUModelRegistry.h"
+#include "FallDetector.h"
+#include "IMURecording.h"
+
+struct IMUWindowResult {
+    int64_t end_us;        // stamp of the newest sample in the window (from the start of the recording in replay)
+    int label;             // 0 Work, 1 Relax, 2 Fall, -1 failed
+    float confidence;
+    int64_t latency_us;    // from the newest sample's arrival to the label
+};
 
 class IMUClassifierThread {
 
 public:
     IMUClassifierThread(const IMUConfig& imu_config)
-        :imu_config_(imu_config), env_(ORT_LOGGING_LEVEL_WARNING, "IMUClassifier"), session(nullptr)  {
+        :imu_config_(imu_config), env_(ORT_LOGGING_LEVEL_WARNING, "IMUClassifier"), models_(env_), fall_detector_(imu_config)  {
             LOG_INFO("IMUClassifierThread Constructor");
         }
+
+    ~IMUClassifierThread() {
+        stop();
+    }
     
     int init() {
-        Ort::SessionOptions session_options;
-        try {
-            session = Ort::Session(env_, imu_config_.imu_model_path.c_str(), session_options);
-        } catch (const Ort::Exception& e) {
-            LOG_ERROR("ONNX Runtime error: " + std::string(e.what()));
+        if (initModel() != 0)
             return 1;
+        if (!imu_config_.i2c_replay_file.empty()) {
+            auto replay = std::make_unique<ReplayI2CBus>(imu_config_.i2c_replay_file, imu_config_.OUT_X_L, imu_config_.WHO_AM_I, LIS2DW12_ID);
+            if (!replay->open())
+                return 1;
+            replay->emulateFifo(imu_config_.FIFO_SAMPLES, imu_config_.odr_hz, 6, FIFO_DEPTH);
+            bus = std::move(replay);
+        } else {
+            auto device = std::make_unique<LinuxI2CBus>(imu_config_.i2c_device, imu_config_.i2c_addr);
+            if (!device->open())
+                return 1;
+            bus = std::move(device);
         }
+        return initialize_sensor();
+    }
 
-        // Get input and output names from the model
-        Ort::AllocatorWithDefaultOptions allocator;
-        input_name = session.GetInputNameAllocated(0, allocator).get();
-        output_name = session.GetOutputNameAllocated(0, allocator).get();
-        // Check output type
-        Ort::TypeInfo output_type_info = session.GetOutputTypeInfo(0);
-        auto output_tensor_info = output_type_info.GetTensorTypeAndShapeInfo();
-        output_type_ = output_tensor_info.GetElementType();
-
-        LOG_INFO("Model input name: " + input_name);
-        LOG_INFO("Model output name: " + output_name);
-        LOG_INFO("Output type: " + std::to_string(output_type_));
-
-        fd = open(imu_config_.i2c_device.c_str(), O_RDWR);
-        if (fd < 0) {            
-            LOG_ERROR("Can't open I2C device");
-            return 1;
-        }
-        if (ioctl(fd, I2C_SLAVE, imu_config_.i2c_addr) < 0) {
-            LOG_ERROR("I2C ioctl failed");
-            close(fd);
-            return 1;
-        }
-        return initialize_sensor(fd);
+    // Enough for replay(); init() also opens the sensor
+    int initModel() {
+        return models_.init(imu_config_) ? 0 : 1;
     }
 
-    void start_IMU(int period_ms) {
-        timer.start(period_ms, 0, [this]() { 
-            std::thread([this]() { ContinuousReadOnce(); }).detach(); 
-        });
+    // Acquisition and inference run on one owned worker; each timer tick asks it to drain the sensor FIFO
+    void start_IMU() {
+        {
+            std::lock_guard<std::mutex> lock(acquire_mutex_);
+            stopping_ = false;
+            acquire_pending_ = false;
+        }
+        if (!worker_.joinable())
+            worker_ = std::thread([this]() { AcquireLoop(); });
+        timer.start(imu_config_.fifo_drain_ms, [this]() { requestAcquisition(); });
     }
 
     void stop() {
         timer.stop();
         {
-            std::lock_guard<std::mutex> lock(window_mutex_);
-            window_.clear();
+            std::lock_guard<std::mutex> lock(acquire_mutex_);
+            stopping_ = true;
         }
+        acquire_cv_.notify_all();
+        if (!worker_.joinable())
+            return;
+        worker_.join();
+        recorder_.close();
+        LOG_INFO("IMU stopped after " + std::to_string(ring_.pushed()) + " samples, " + std::to_string(classified_windows_) + " windows, "
+                 + std::to_string(fifo_overruns_) + " FIFO overruns, " + std::to_string(coalesced_ticks_) + " ticks coalesced");
+        LOG_INFO("IMU window to label " + label_latency_.summary() + ", " + std::to_string(dropped_windows_) + " windows dropped, models:\n" + models_.summary());
+    }
+
+    // Per-model latency, load memory and shadow agreement so far
+    std::string modelSummary() const {
+        return models_.summary();
+    }
+
+    // Feeds a recording (see IMURecording.h) through the same windowing, features, fall detector and model as the
+    // sensor, on the calling thread. realtime paces samples at their recorded stamps; otherwise it runs flat out.
+    // Not while start_IMU() is running.
+    bool replay(const std::string& path, bool realtime) {
+        if (worker_.joinable()) {
+            LOG_ERROR("IMU replay requested while acquisition is running");
+            return false;
+        }
+        IMURecordingReader reader;
+        if (!reader.open(path))
+            return false;
+        resetStream();
+        sample_period_us_ = 1000000 / reader.odr_hz;
+        int64_t base = nowUs();
+        int64_t stamp;
+        int16_t x, y, z;
+        while (reader.next(stamp, x, y, z)) {
+            if (realtime)
+                std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::microseconds(base + stamp)));
+            ingest(stamp, x, y, z, realtime ? base + stamp : nowUs());
+            // Flat out, windows queue up and go to the models in full batches
+            if (realtime || pending_windows_.size() >= models_.maxBatch())
+                classifyWindows();
+        }
+        classifyWindows();
+        return true;
     }
 
     void setResultCallback(std::function<void(const QString)> callback) {
         result_callback = callback;
     } 
 
+    // Provisional falls come from the per-sample detector, ahead of the classifier, which then confirms or retracts them
+    void setFallCallback(std::function<void(const FallEvent&)> callback) {
+        fall_callback = callback;
+    }
+
+    void setWindowCallback(std::function<void(const IMUWindowResult&)> callback) {
+        window_callback = callback;
+    }
+
 private:
     IMUConfig imu_config_;
     Ort::Env env_; 
-    Ort::Session session;
-    std::vector<float> features_;
-    std::mutex features_mutex_;
-    Timer timer;
+    IMUModelRegistry models_;
+    Timer timer{"default", "imu"};
     std::function<void(const QString)> result_callback;
-    std::string input_name;  
-    std::string output_name; 
-    std::deque<std::array<float, 3>> window_;
-    ONNXTensorElementDataType output_type_;
-    std::mutex window_mutex_;
-    std::condition_variable window_cv_;
+    std::function<void(const FallEvent&)> fall_callback;
+    std::function<void(const IMUWindowResult&)> window_callback;
     static constexpr size_t WINDOW_SIZE = 180;
-    bool ready = false;
-    int fd = -1;
+    static constexpr int LIS2DW12_ID = 0x44;
+    static constexpr uint8_t CTRL2_BDU = 0x08;           // output registers update only after both bytes are read
+    static constexpr uint8_t CTRL2_IF_ADD_INC = 0x04;    // register address auto-increment for burst reads
+    static constexpr uint8_t FIFO_MODE_BYPASS = 0x00;
+    static constexpr uint8_t FIFO_MODE_CONTINUOUS = 0xC0;
+    static constexpr uint8_t FIFO_SAMPLES_OVR = 0x40;
+    static constexpr uint8_t FIFO_SAMPLES_DIFF = 0x3F;
+    static constexpr size_t FIFO_DEPTH = 32;
+    std::unique_ptr<I2CBus> bus;
+    IMUSampleRing ring_{4 * WINDOW_SIZE};
+    IMUFeatures window_features_{WINDOW_SIZE};    // running sums over the newest WINDOW_SIZE samples in ring_
+    FallDetector fall_detector_;
+    std::optional<FallEvent> pending_fall_;    // provisional fall waiting for the classifier
+    int fall_windows_seen_ = 0;
+    int64_t sample_period_us_ = 5000;    // sensor ODR period
+    int64_t next_stamp_us_ = 0;          // stamp of the next sample to leave the FIFO
+    int decimation_ = 4;                 // FIFO samples per sample kept (odr_hz / sample_hz)
+    int decimation_phase_ = 0;           // FIFO samples since the last one kept
+    uint64_t last_classified_ = 0;       // ring_.pushed() at the last classification
+    size_t classified_windows_ = 0;
+    size_t fifo_overruns_ = 0;
+    struct PendingWindow {
+        int64_t end_us;
+        int64_t arrival_us;    // when its newest sample became available to the host
+    };
+    std::vector<PendingWindow> pending_windows_;    // hop windows waiting for the next batched run
+    std::vector<float> pending_features_;           // IMUInference::FEATURES per pending window
+    std::vector<int> batch_labels_;
+    std::vector<float> batch_confidences_;
+    size_t dropped_windows_ = 0;
+    LatencyHistogram label_latency_;
+    IMURecorder recorder_;
+    std::thread worker_;
+    std::mutex acquire_mutex_;
+    std::condition_variable acquire_cv_;
+    bool acquire_pending_ = false;    // at most one drain waits behind the running one
+    bool acquiring_ = false;
+    bool stopping_ = false;
+    size_t coalesced_ticks_ = 0;    // ticks that found a drain already running or pending
 
-    int read_reg(int fd, int reg) {
-        uint8_t buf[1] = {static_cast<uint8_t>(reg)};
-        if (write(fd, buf, 1) != 1) return -1;
-        if (read(fd, buf, 1) != 1) return -1;
-        return buf[0];
+    // CTRL1 ODR field for the configured rate; the low nibble (mode, low-power mode) comes from ON_CTRL1
+    static uint8_t odrBits(int odr_hz) {
+        static const std::pair<int, uint8_t> rates[] = {{12, 0x20}, {25, 0x30}, {50, 0x40}, {100, 0x50}, {200, 0x60}, {400, 0x70}, {800, 0x80}, {1600, 0x90}};
+        for (const auto& rate : rates)
+            if (odr_hz <= rate.first)
+                return rate.second;
+        return 0x90;
     }
 
-    void write_reg(int fd, int reg, int value) {
-        uint8_t buf[2] = {static_cast<uint8_t>(reg), static_cast<uint8_t>(value)};
-        write(fd, buf, 2);
-    }
-
-    int initialize_sensor(int fd) {
-        if (read_reg(fd, imu_config_.WHO_AM_I) != 0x44) {
+    int initialize_sensor() {
+        if (bus->readReg(imu_config_.WHO_AM_I) != LIS2DW12_ID) {
             LOG_ERROR("Device not LIS2DW12TR!");
             return 1;
         }
-        write_reg(fd, imu_config_.CTRL1, imu_config_.ON_CTRL1);
+        int ctrl2 = bus->readReg(imu_config_.CTRL2);
+        if (ctrl2 < 0 || !bus->writeReg(imu_config_.CTRL2, static_cast<uint8_t>(ctrl2 | CTRL2_BDU | CTRL2_IF_ADD_INC))) {
+            LOG_ERROR("Can't enable LIS2DW12 burst reads");
+            return 1;
+        }
+        sample_period_us_ = 1000000 / imu_config_.odr_hz;
+        decimation_ = std::max(1, imu_config_.odr_hz / std::max(1, imu_config_.sample_hz));
+        bus->writeReg(imu_config_.CTRL1, static_cast<uint8_t>(odrBits(imu_config_.odr_hz) | (imu_config_.ON_CTRL1 & 0x0F)));
         return 0;
     }
 
-    void read_accel(int fd, int16_t &x, int16_t &y, int16_t &z) {
-        auto read_axis = [&](int l, int h) {
-            uint16_t raw = (static_cast<uint16_t>(read_reg(fd, h)) << 8) | static_cast<uint16_t>(read_reg(fd, l));
-            return static_cast<int16_t>(raw);
-        };
-        x = read_axis(imu_config_.OUT_X_L, imu_config_.OUT_X_H);
-        y = read_axis(imu_config_.OUT_Y_L, imu_config_.OUT_Y_H);
-        z = read_axis(imu_config_.OUT_Z_L, imu_config_.OUT_Z_H);
+    // Bypass then continuous mode empties the FIFO, so stale samples from before start_IMU are dropped
+    void restartFifo() {
+        bus->writeReg(imu_config_.FIFO_CTRL, FIFO_MODE_BYPASS);
+        bus->writeReg(imu_config_.FIFO_CTRL, FIFO_MODE_CONTINUOUS);
+        resetStream();
     }
 
-    void ContinuousRead() {
-        while (!ready) {
-            int16_t x, y, z;
-            read_accel(fd, x, y, z);            
-            {
-                std::lock_guard<std::mutex> lock(window_mutex_);
-                window_.push_back({static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
-                if (window_.size() > WINDOW_SIZE) {  // Keep some buffer
-                    window_.erase(window_.begin(), window_.begin() + (window_.size() - WINDOW_SIZE));
-                    ready = true;
-                }
-            } 
-            if (ready) {
-                CaptureIMU();
-            }           
-            usleep(50);
+    void resetStream() {
+        ring_.clear();
+        window_features_.clear();
+        pending_windows_.clear();
+        pending_features_.clear();
+        fall_detector_.reset();
+        pending_fall_.reset();
+        last_classified_ = 0;
+        next_stamp_us_ = 0;
+        decimation_phase_ = 0;
+    }
+
+    static int64_t nowUs() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Timer tick: overlapping requests collapse into one pending drain
+    void requestAcquisition() {
+        {
+            std::lock_guard<std::mutex> lock(acquire_mutex_);
+            if (acquire_pending_ || acquiring_) {
+                ++coalesced_ticks_;
+                if (acquire_pending_)
+                    return;
+            }
+            acquire_pending_ = true;
         }
+        acquire_cv_.notify_one();
     }
 
-    void ContinuousReadOnce() {
-        std::deque<std::array<float, 3>> temp_window;
-        for (size_t i = 0; i < WINDOW_SIZE; ++i) {
-            int16_t x, y, z;
-            read_accel(fd, x, y, z);
-            temp_window.push_back({static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
-            usleep(20000); // 20 ms between samples (~50 Hz)
+    void AcquireLoop() {
+        restartFifo();
+        if (!imu_config_.record_file.empty())
+            recorder_.open(imu_config_.record_file, imu_config_.odr_hz / decimation_);
+        std::unique_lock<std::mutex> lock(acquire_mutex_);
+        while (true) {
+            acquire_cv_.wait(lock, [this] { return stopping_ || acquire_pending_; });
+            if (stopping_)
+                return;
+            acquire_pending_ = false;
+            acquiring_ = true;
+            lock.unlock();
+            drainFifo();
+            classifyWindows();
+            lock.lock();
+            acquiring_ = false;
         }
-        // Copy to member window_ for processing (if needed by CaptureIMU)
-        {
-            std::lock_guard<std::mutex> lock(window_mutex_);
-            window_ = temp_window;
+    }
+
+    // Reads every queued FIFO level in one burst; the register pointer wraps from OUT_Z_H back to OUT_X_L
+    void drainFifo() {
+        int level = bus->readReg(imu_config_.FIFO_SAMPLES);
+        if (level < 0)
+            return;
+        size_t count = std::min<size_t>(level & FIFO_SAMPLES_DIFF, FIFO_DEPTH);
+        if (count == 0)
+            return;
+        uint8_t raw[FIFO_DEPTH * 6];
+        if (!bus->readRegs(imu_config_.OUT_X_L, raw, count * 6))
+            return;
+
+        // The sensor clock spaces samples exactly; the host clock only anchors the newest one. Re-anchor after an
+        // overrun (samples were lost) or when the two clocks drift more than a few periods apart.
+        int64_t newest = nowUs();
+        int64_t expected = next_stamp_us_ + static_cast<int64_t>(count - 1) * sample_period_us_;
+        if (level & FIFO_SAMPLES_OVR) {
+            ++fifo_overruns_;
+            LOG_WARN("IMU FIFO overrun, drain period too long for the ODR");
         }
-        ready = true;
-        CaptureIMU();
+        if (next_stamp_us_ == 0 || (level & FIFO_SAMPLES_OVR) || std::llabs(expected - newest) > 4 * sample_period_us_)
+            next_stamp_us_ = newest - static_cast<int64_t>(count - 1) * sample_period_us_;
+
+        // The models were trained on point samples of the 200 Hz stream taken every 20 ms, so only every
+        // decimation_-th sample is kept (no averaging); the recording holds the kept samples only
+        auto axis = [&](size_t i) { return static_cast<int16_t>(static_cast<uint16_t>(raw[i + 1]) << 8 | raw[i]); };
+        for (size_t i = 0; i < count; ++i, next_stamp_us_ += sample_period_us_) {
+            bool keep = decimation_phase_ == 0;
+            decimation_phase_ = (decimation_phase_ + 1) % decimation_;
+            if (!keep)
+                continue;
+            int16_t x = axis(i * 6), y = axis(i * 6 + 2), z = axis(i * 6 + 4);
+            recorder_.append(next_stamp_us_, x, y, z);
+            ingest(next_stamp_us_, x, y, z, newest);
+        }
+        recorder_.flush();
     }
 
-    void CaptureIMU() {
+    // One sample into the ring, the running window sums and the fall detector; every window_hop samples the
+    // window's features are queued for classifyWindows()
+    void ingest(int64_t stamp_us, int16_t x, int16_t y, int16_t z, int64_t arrival_us) {
+        ring_.push({stamp_us, static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
+        window_features_.add(x, y, z);
+        FallEvent fall;
+        if (fall_detector_.add(ring_.back(), fall))
+            raiseFall(fall);
+        if (window_features_.size() > WINDOW_SIZE) {
+            const IMUSample& leaving = ring_.back(WINDOW_SIZE);
+            window_features_.remove(static_cast<int32_t>(leaving.x), static_cast<int32_t>(leaving.y), static_cast<int32_t>(leaving.z));
+        }
+        if (ring_.size() < WINDOW_SIZE)
+            return;
+        if (last_classified_ != 0 && ring_.pushed() - last_classified_ < static_cast<uint64_t>(imu_config_.window_hop))
+            return;
+        last_classified_ = ring_.pushed();
+        // A batch's worth is already waiting behind a slow inference: keep the newest windows
+        if (pending_windows_.size() >= models_.maxBatch()) {
+            pending_windows_.erase(pending_windows_.begin());
+            pending_features_.erase(pending_features_.begin(), pending_features_.begin() + IMUInference::FEATURES);
+            ++dropped_windows_;
+        }
+        pending_windows_.push_back({stamp_us, arrival_us});
+        std::vector<float> features = window_features_.features();
+        pending_features_.insert(pending_features_.end(), features.begin(), features.end());
+    }
+
+    // All queued hop windows go through the models in one batched run, then out in order
+    void classifyWindows() {
+        if (pending_windows_.empty())
+            return;
+        size_t batch = pending_windows_.size();
+        batch_labels_.resize(batch);
+        batch_confidences_.resize(batch);
         try {
-            if (ready) {
-                // 1. Read new sample
-                std::deque<std::array<float, 3>> current_window;        
-                
-                // Lock and copy the current window
-                {
-                    std::unique_lock<std::mutex> lock(window_mutex_);
-                    if (window_.size() < WINDOW_SIZE) {
-                        LOG_INFO("Not enough samples yet: " + std::to_string(window_.size()));
-                        return;
-                    }
-                    current_window.assign(window_.end() - WINDOW_SIZE, window_.end());
-                }                      
-                // 2. Compute features on current window_
-                std::vector<float> feature_vec = compute_features(current_window);
-                if (feature_vec.size() != 18) {
-                    LOG_ERROR("Unexpected feature vector size");
-                    return;
-                }
+            models_.run(pending_features_.data(), batch, batch_labels_.data(), batch_confidences_.data());
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error in classifyWindows: " + std::string(e.what()));
+            std::fill(batch_labels_.begin(), batch_labels_.end(), -1);
+        }
+        int64_t now = nowUs();
+        for (size_t i = 0; i < batch; ++i)
+            CaptureIMU({pending_windows_[i].end_us, batch_labels_[i], batch_confidences_[i], now - pending_windows_[i].arrival_us});
+        classified_windows_ += batch;
+        pending_windows_.clear();
+        pending_features_.clear();
+    }
 
-                Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-                std::array<int64_t, 2> input_shape{1, (int64_t)feature_vec.size()};
-                
-                // Create input tensor
-                Ort::Value input_tensor = Ort::Value::CreateTensor<float>(
-                    memory_info, feature_vec.data(), feature_vec.size(),
-                    input_shape.data(), input_shape.size()
-                );
-                
-                // Prepare input/output names
-                std::vector<const char*> input_names{input_name.c_str()};
-                std::vector<const char*> output_names{output_name.c_str()};
-                
-                // Run inference
-                auto output_tensors = session.Run(
-                    Ort::RunOptions{nullptr},
-                    input_names.data(), &input_tensor, 1,
-                    output_names.data(), 1
-                );
-                
-                // Process output based on type
-                int label = -1;
-                float confidence = 0.0f;
-                
-                if (output_tensors.size() > 0) {
-                    if (output_type_ == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64) {
-                        int64_t* output = output_tensors[0].GetTensorMutableData<int64_t>();
-                        label = static_cast<int>(output[0]) - 1; // Match Python's -1 adjustment
-                        confidence = 1.0f; // No confidence score for integer outputs
-                    } 
-                    else if (output_type_ == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
-                        float* output = output_tensors[0].GetTensorMutableData<float>();
-                        int max_idx = std::distance(output, std::max_element(output, output + 3));
-                        label = max_idx;
-                        confidence = output[max_idx];
-                        LOG_INFO(std::to_string(confidence));        
-                    }
-                    
-                    QString activity;
-                    if (label == 0) activity = "Work";
-                    else if (label == 1) activity = "Relax";
-                    else if (label == 2) activity = "Fall";
-                    else activity = "Unknown";
-                    if (result_callback) {
-                        result_callback(activity);
-                    }
-                    
-                    window_.clear();
-                    ready = false;
-                }
+    void CaptureIMU(const IMUWindowResult& result) {
+        try {
+            int label = result.label;
+            LOG_DEBUGF("label {} confidence {}", label, result.confidence);
+            label_latency_.add(result.latency_us);
+            if (window_callback)
+                window_callback(result);
+
+            QString activity;
+            if (label == 0) activity = "Work";
+            else if (label == 1) activity = "Relax";
+            else if (label == 2) activity = "Fall";
+            else activity = "Unknown";
+            if (result_callback) {
+                result_callback(activity);
             }
+            resolveFall(result);
         } catch (const std::exception& e) {
             LOG_ERROR("Error in CaptureIMU: " + std::string(e.what()));
         }
     }
 
-    std::vector<float> compute_features(const std::deque<std::array<float, 3>>& win) {
-        auto mean = [](const std::vector<float>& v) {
-            return std::accumulate(v.begin(), v.end(), 0.0f) / v.size();
-        };
-        auto stddev = [&](const std::vector<float>& v, float m) {
-            float s = 0.0f; for (auto x : v) s += (x-m)*(x-m);
-            return std::sqrt(s/v.size());
-        };
-        auto var = [&](const std::vector<float>& v, float m) {
-            float s = 0.0f; for (auto x : v) s += (x-m)*(x-m);
-            return s/v.size();
-        };
-        auto ener = [](const std::vector<float>& v) {
-            float s = 0.0f; for (auto x : v) s += x*x; return s;
-        };
-        auto pearson = [](const std::vector<float>& a, const std::vector<float>& b) {
-            if (a.size() != b.size()) return std::make_pair(0.0f, 0.0f);
-            
-            float sum_a = std::accumulate(a.begin(), a.end(), 0.0f);
-            float sum_b = std::accumulate(b.begin(), b.end(), 0.0f);
-            float mean_a = sum_a / a.size();
-            float mean_b = sum_b / b.size();
-            
-            float cov = 0.0f, var_a = 0.0f, var_b = 0.0f;
-            for (size_t i = 0; i < a.size(); ++i) {
-                float da = a[i] - mean_a;
-                float db = b[i] - mean_b;
-                cov += da * db;
-                var_a += da * da;
-                var_b += db * db;
-            }
-            
-            float denom = std::sqrt(var_a * var_b);
-            float r = (denom != 0) ? cov / denom : 0.0f;
-            return std::make_pair(r, 0.0f); // p-value not calculated
-        };        
-        std::vector<float> x, y, z;
-        for (const auto& arr : win) {
-            x.push_back(arr[0]);
-            y.push_back(arr[1]);
-            z.push_back(arr[2]);
-        }
-        float x_mean = mean(x), y_mean = mean(y), z_mean = mean(z);
-        float xstd = stddev(x, x_mean), ystd = stddev(y, y_mean), zstd = stddev(z, z_mean);
-        float xvar = var(x, x_mean), yvar = var(y, y_mean), zvar = var(z, z_mean);
-        float xner = ener(x), yner = ener(y), zner = ener(z);
-        auto [xcor_r, xcor_p] = pearson(x, y);
-        auto [ycor_r, ycor_p] = pearson(y, z);
-        auto [zcor_r, zcor_p] = pearson(z, x);
-        // std::vector<float> feats(18, 0.0f);
-        // p-values not calculated here
-        std::vector<float> feats = {x_mean, y_mean, z_mean, xstd, ystd, zstd, xvar, yvar, zvar,
-                    xner, yner, zner, xcor_r, ycor_r, zcor_r, xcor_p, ycor_p, zcor_p};
-        // Fill feats[...] using window data
-        return feats;
+    void raiseFall(const FallEvent& fall) {
+        LOG_WARNF("IMU provisional fall: free-fall {} ms, impact {} g", fall.freefall_us / 1000, fall.impact_g);
+        pending_fall_ = fall;
+        fall_windows_seen_ = 0;
+        if (fall_callback)
+            fall_callback(fall);
+    }
+
+    // Windows ending after the impact contain it; the first Fall label among them confirms, fall_confirm_windows
+    // windows without one retract
+    void resolveFall(const IMUWindowResult& result) {
+        if (!pending_fall_ || result.end_us < pending_fall_->stamp_us)
+            return;
+        if (result.label == 2)
+            pending_fall_->phase = FallEvent::Confirmed;
+        else if (++fall_windows_seen_ >= imu_config_.fall_confirm_windows)
+            pending_fall_->phase = FallEvent::Retracted;
+        else
+            return;
+        LOG_INFO(std::string("IMU fall ") + (pending_fall_->phase == FallEvent::Confirmed ? "confirmed" : "retracted") + " by the classifier");
+        if (fall_callback)
+            fall_callback(*pending_fall_);
+        pending_fall_.reset();
     }
 };
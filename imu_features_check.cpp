@@ -0,0 +1,137 @@
+// Checks IMUFeatures (the incremental window features the classifier runs on) against the reference implementation
+// matched to the model's training scripts, over every hop window of IMU recordings (imu.record_file, see IMURecording.h).
+// g++ -std=c++17 -O2 -o imu_features_check imu_features_check.cpp -ljsoncpp -lpthread
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <array>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "IMUFeatures.h"
+#include "IMURecording.h"
+
+static const char* FEATURE_NAMES[IMUFeatures::COUNT] = {"x_mean", "y_mean", "z_mean", "xstd", "ystd", "zstd", "xvar", "yvar", "zvar",
+                                                        "xner", "yner", "zner", "xcor_r", "ycor_r", "zcor_r", "xcor_p", "ycor_p", "zcor_p"};
+
+// Reference implementation matched to the training scripts; IMUFeatures computes the same vector incrementally
+static std::vector<float> compute_features(const std::deque<std::array<float, 3>>& win) {
+    auto mean = [](const std::vector<float>& v) {
+        return std::accumulate(v.begin(), v.end(), 0.0f) / v.size();
+    };
+    auto stddev = [&](const std::vector<float>& v, float m) {
+        float s = 0.0f; for (auto x : v) s += (x-m)*(x-m);
+        return std::sqrt(s/v.size());
+    };
+    auto var = [&](const std::vector<float>& v, float m) {
+        float s = 0.0f; for (auto x : v) s += (x-m)*(x-m);
+        return s/v.size();
+    };
+    auto ener = [](const std::vector<float>& v) {
+        float s = 0.0f; for (auto x : v) s += x*x; return s;
+    };
+    auto pearson = [](const std::vector<float>& a, const std::vector<float>& b) {
+        if (a.size() != b.size()) return std::make_pair(0.0f, 0.0f);
+
+        float sum_a = std::accumulate(a.begin(), a.end(), 0.0f);
+        float sum_b = std::accumulate(b.begin(), b.end(), 0.0f);
+        float mean_a = sum_a / a.size();
+        float mean_b = sum_b / b.size();
+
+        float cov = 0.0f, var_a = 0.0f, var_b = 0.0f;
+        for (size_t i = 0; i < a.size(); ++i) {
+            float da = a[i] - mean_a;
+            float db = b[i] - mean_b;
+            cov += da * db;
+            var_a += da * da;
+            var_b += db * db;
+        }
+
+        float denom = std::sqrt(var_a * var_b);
+        float r = (denom != 0) ? cov / denom : 0.0f;
+        return std::make_pair(r, 0.0f); // p-value not calculated
+    };
+    std::vector<float> x, y, z;
+    for (const auto& arr : win) {
+        x.push_back(arr[0]);
+        y.push_back(arr[1]);
+        z.push_back(arr[2]);
+    }
+    float x_mean = mean(x), y_mean = mean(y), z_mean = mean(z);
+    float xstd = stddev(x, x_mean), ystd = stddev(y, y_mean), zstd = stddev(z, z_mean);
+    float xvar = var(x, x_mean), yvar = var(y, y_mean), zvar = var(z, z_mean);
+    float xner = ener(x), yner = ener(y), zner = ener(z);
+    auto [xcor_r, xcor_p] = pearson(x, y);
+    auto [ycor_r, ycor_p] = pearson(y, z);
+    auto [zcor_r, zcor_p] = pearson(z, x);
+    // p-values not calculated here
+    return {x_mean, y_mean, z_mean, xstd, ystd, zstd, xvar, yvar, zvar,
+            xner, yner, zner, xcor_r, ycor_r, zcor_r, xcor_p, ycor_p, zcor_p};
+}
+
+int main(int argc, char* argv[]) {
+    size_t window = 180;
+    size_t hop = 30;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--window" && has_value) {
+            window = std::stoul(argv[++i]);
+        } else if (arg == "--hop" && has_value) {
+            hop = std::stoul(argv[++i]);
+        } else if (arg.rfind("--", 0) == 0) {
+            files.clear();
+            break;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty() || window == 0 || hop == 0) {
+        std::cerr << "Usage: " << argv[0] << " [--window 180] [--hop 30] <recording>..." << std::endl;
+        return 1;
+    }
+
+    int status = 0;
+    for (const auto& path : files) {
+        IMURecordingReader reader;
+        if (!reader.open(path)) {
+            status = 1;
+            continue;
+        }
+        IMUFeatures features(window);
+        std::deque<std::array<float, 3>> win;
+        double max_diff[IMUFeatures::COUNT] = {};
+        uint64_t samples = 0, windows = 0;
+        int64_t stamp;
+        int16_t x, y, z;
+        while (reader.next(stamp, x, y, z)) {
+            features.add(x, y, z);
+            win.push_back({static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)});
+            if (win.size() > window) {
+                const auto& leaving = win.front();
+                features.remove(static_cast<int32_t>(leaving[0]), static_cast<int32_t>(leaving[1]), static_cast<int32_t>(leaving[2]));
+                win.pop_front();
+            }
+            // The first full window, then every hop samples, as the classifier queues them
+            if (win.size() < window || samples++ % hop != 0)
+                continue;
+            ++windows;
+            std::vector<float> incremental = features.features();
+            std::vector<float> reference = compute_features(win);
+            // Relative to the reference value for the moments, absolute for the correlations
+            for (size_t k = 0; k < IMUFeatures::COUNT; ++k) {
+                double diff = std::fabs(static_cast<double>(incremental[k]) - reference[k]);
+                if (k < 12)
+                    diff /= std::max(1.0, std::fabs(static_cast<double>(reference[k])));
+                max_diff[k] = std::max(max_diff[k], diff);
+            }
+        }
+        std::printf("%s: %llu windows of %zu samples\n", path.c_str(), static_cast<unsigned long long>(windows), window);
+        for (size_t k = 0; k < IMUFeatures::COUNT; ++k)
+            std::printf("  %-7s max %s difference %.3g\n", FEATURE_NAMES[k], k < 12 ? "relative" : "absolute", max_diff[k]);
+    }
+    Logger::flush();
+    return status;
+}
@@ -0,0 +1,98 @@
+// Replays IMU recordings (imu.record_file, see IMURecording.h) through the classifier: label timeline, throughput and
+// window-to-label latency, without the helmet. Each --model replaces the configured imu.models; the first is primary,
+// the rest are compared against it.
+// g++ -std=c++17 -O2 -fPIC -o imu_replay imu_replay.cpp -I/home/x_user/my_camera_project/onnxruntime/include $(pkg-config --cflags --libs Qt5Core)
+//     -L/home/x_user/my_camera_project -lonnxruntime -ljsoncpp -lpthread
+#include <QString>
+#include <numeric>
+#include <algorithm>
+#include <deque>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include "imu_classifier_thread.h"
+
+static const char* LABEL_NAMES[] = {"Work", "Relax", "Fall"};
+
+int main(int argc, char* argv[]) {
+    std::string config_path = "/home/x_user/my_camera_project/configuration_ap.json";
+    std::vector<std::string> model_paths;
+    bool realtime = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--realtime") {
+            realtime = true;
+        } else if (arg == "--config" && has_value) {
+            config_path = argv[++i];
+        } else if (arg == "--model" && has_value) {
+            model_paths.push_back(argv[++i]);
+        } else if (arg.rfind("--", 0) == 0) {
+            files.clear();
+            break;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--config configuration_ap.json] [--model model.onnx]... [--realtime] <recording>..." << std::endl;
+        return 1;
+    }
+
+    IMUConfig imu_config;
+    try {
+        imu_config = Configuration(config_path).imu;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    if (!model_paths.empty()) {
+        imu_config.models.clear();
+        for (const auto& path : model_paths)
+            imu_config.models.push_back({std::filesystem::path(path).stem().string(), path, ""});
+    }
+    imu_config.ort_optimized_model_path.clear();    // never overwrite the device's cached models from here
+    for (auto& model : imu_config.models)
+        model.optimized_path.clear();
+
+    IMUClassifierThread classifier(imu_config);
+    if (classifier.initModel() != 0) {
+        std::cerr << "Error: Could not load the primary model" << std::endl;
+        return 1;
+    }
+
+    int status = 0;
+    for (const auto& path : files) {
+        LatencyHistogram latency;
+        uint64_t windows = 0;
+        uint64_t counts[4] = {};
+        classifier.setWindowCallback([&](const IMUWindowResult& result) {
+            latency.add(result.latency_us);
+            ++windows;
+            ++counts[result.label >= 0 && result.label < 3 ? result.label : 3];
+            std::printf("%9.2f  %-7s %.3f  %lld us\n", result.end_us / 1e6, result.label >= 0 && result.label < 3 ? LABEL_NAMES[result.label] : "Unknown",
+                        result.confidence, static_cast<long long>(result.latency_us));
+        });
+        classifier.setFallCallback([&](const FallEvent& event) {
+            static const char* phases[] = {"provisional", "confirmed", "retracted"};
+            std::printf("           fall %s (free-fall %lld ms, impact %.2f g)\n", phases[event.phase], static_cast<long long>(event.freefall_us / 1000), event.impact_g);
+        });
+
+        std::printf("# %s\n#   end_s  label   conf   latency\n", path.c_str());
+        auto started = std::chrono::steady_clock::now();
+        if (!classifier.replay(path, realtime)) {
+            std::cerr << "Error: Could not replay " << path << std::endl;
+            status = 1;
+            continue;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::printf("# %llu windows (Work %llu, Relax %llu, Fall %llu, Unknown %llu) in %.3f s, %.0f windows/s\n", static_cast<unsigned long long>(windows),
+                    static_cast<unsigned long long>(counts[0]), static_cast<unsigned long long>(counts[1]), static_cast<unsigned long long>(counts[2]),
+                    static_cast<unsigned long long>(counts[3]), seconds, seconds > 0 ? windows / seconds : 0.0);
+        std::printf("# window to label latency %s\n", latency.summary().c_str());
+    }
+    std::printf("# models (cumulative):\n%s\n", classifier.modelSummary().c_str());
+    Logger::flush();
+    return status;
+}
@@ -0,0 +1,129 @@
+// Logger microbenchmark: cost of a statement below the runtime level (against building its message eagerly, as the
+// macros did before), caller-side latency and throughput of enabled LOG_INFO / LOG_INFOF from several threads, records
+// dropped on full rings (a tight loop overruns them, --interval-us paces the callers) and the time to drain them.
+// Writes to FOLOG.log, or to binary events with --events.
+// Build with -DLOG_COMPILE_LEVEL=1 to see LOG_DEBUG compiled out entirely.
+// g++ -std=c++17 -O2 -o log_bench log_bench.cpp -lpthread
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include "Logger.h"
+
+static double nsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Latencies {
+    std::vector<double> ns;
+
+    double percentile(double p) {
+        if (ns.empty())
+            return 0.0;
+        size_t k = std::min(ns.size() - 1, static_cast<size_t>(p * ns.size()));
+        std::nth_element(ns.begin(), ns.begin() + k, ns.end());
+        return ns[k];
+    }
+};
+
+// count statements per thread, interval_us apart; formatted picks LOG_INFOF over LOG_INFO with a concatenated message
+static void runEnabled(const char* name, size_t threads, size_t count, int interval_us, bool formatted) {
+    std::vector<Latencies> latencies(threads);
+    std::vector<std::thread> workers;
+    size_t dropped_before = Logger::dropped();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            Latencies& mine = latencies[t];
+            mine.ns.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                double confidence = 0.5 + (i % 50) / 100.0;
+                auto call = std::chrono::steady_clock::now();
+                if (formatted)
+                    LOG_INFOF("bench thread {} sample {} confidence {}", t, i, confidence);
+                else
+                    LOG_INFO("bench thread " + std::to_string(t) + " sample " + std::to_string(i) + " confidence " + std::to_string(confidence));
+                mine.ns.push_back(nsSince(call));
+                if (interval_us > 0)
+                    std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+            }
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    double wall_ns = nsSince(start);
+    auto drain_start = std::chrono::steady_clock::now();
+    Logger::flush();
+    double drain_ms = nsSince(drain_start) / 1e6;
+
+    Latencies all;
+    for (auto& mine : latencies)
+        all.ns.insert(all.ns.end(), mine.ns.begin(), mine.ns.end());
+    size_t total = threads * count;
+    size_t dropped = Logger::dropped() - dropped_before;
+    std::printf("%-8s %zu threads: %8.0f records/s, call p50 %6.0f ns p99 %7.0f ns max %8.0f ns, dropped %zu (%.1f%%), final drain %.2f ms\n",
+                name, threads, total / (wall_ns / 1e9), all.percentile(0.5), all.percentile(0.99), all.percentile(1.0),
+                dropped, 100.0 * dropped / total, drain_ms);
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = 100000;
+    size_t threads = 4;
+    int interval_us = 0;
+    std::string events;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--count" && has_value) {
+            count = std::stoul(argv[++i]);
+        } else if (arg == "--threads" && has_value) {
+            threads = std::stoul(argv[++i]);
+        } else if (arg == "--interval-us" && has_value) {
+            interval_us = std::stoi(argv[++i]);
+        } else if (arg == "--events" && has_value) {
+            events = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--count 100000 per thread] [--threads 4] [--interval-us 0] [--events <binary log path>]" << std::endl;
+            return 1;
+        }
+    }
+    if (count == 0 || threads == 0) {
+        std::cerr << "--count and --threads must be positive" << std::endl;
+        return 1;
+    }
+    if (!events.empty() && !Logger::useEventLog(events, 64ull << 20, 2)) {
+        std::cerr << "Can't open " << events << std::endl;
+        return 1;
+    }
+    Logger::setLevels(Logger::LEVEL_INFO, {});
+
+    // Disabled: LOG_DEBUG below the runtime level never builds its message
+    volatile size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        std::string message = "frame " + std::to_string(i) + " qr " + std::to_string(i * 7);
+        sink = sink + message.size();
+    }
+    double eager_ns = nsSince(start) / count;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i)
+        LOG_DEBUG("frame " + std::to_string(i) + " qr " + std::to_string(i * 7));
+    double disabled_ns = nsSince(start) / count;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i)
+        LOG_DEBUGF("frame {} qr {}", i, i * 7);
+    double disabled_format_ns = nsSince(start) / count;
+    std::printf("disabled LOG_DEBUG %.2f ns, LOG_DEBUGF %.2f ns per statement (building the message alone: %.1f ns)\n",
+                disabled_ns, disabled_format_ns, eager_ns);
+
+    std::printf("%zu statements per thread to %s\n", count, events.empty() ? "FOLOG.log" : events.c_str());
+    for (size_t n : {static_cast<size_t>(1), threads}) {
+        runEnabled("LOG_INFO", n, count, interval_us, false);
+        runEnabled("LOG_INFOF", n, count, interval_us, true);
+    }
+    Logger::flush();
+    return 0;
+}
@@ -33,7 +33,23 @@ HEADERS += camera_viewer.h \
             videocontroller.h \
             LanguageManager.h \
             FloatingMessage.h \
-            imu_classifier_thread.h
+            imu_classifier_thread.h \
+            KeyframeIndex.h \
+            FileCatalog.h \
+            DiskPageCache.h \
+            PageRenderer.h \
+            TextSearchIndex.h \
+            ReportWriter.h \
+            ReportJournal.h \
+            EventLog.h \
+            Scheduler.h \
+            I2CBus.h \
+            IMUSampleRing.h \
+            IMUFeatures.h \
+            IMUInference.h \
+            FallDetector.h \
+            IMURecording.h \
+            IMUModelRegistry.h
 
 INCLUDEPATH += /usr/include/opencv4 \
                /usr/include/gstreamer-1.0 \
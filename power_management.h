@@ -80,7 +80,7 @@ public:
 
     // Start periodic battery status updates
     void start_updates() {
-        timer.start(config.READING_DELAY, 0, [this]() { check_battery_status(); });
+        timer.start(config.READING_DELAY, [this]() { check_battery_status(); });
     }
 
     // Stop periodic battery status updates
@@ -96,7 +96,7 @@ private:
     int current_counter;
     std::chrono::steady_clock::time_point last_log_time;
     std::thread thread;
-    Timer timer;
+    Timer timer{"default", "battery"};
     std::function<void(BatteryStatus)> battery_status_callback;
 
     std::string battery_status_to_string(BatteryStatus status) const {
@@ -232,6 +232,7 @@ private:
                             << battery_status_to_string(new_status) << ", "
                             << config.SAMPLING_INTERVAL << "\n";
 
+                LOG_INFOF("battery sample {} level {} percentage {} status {}", current_counter, battery_stats.level, static_cast<int>(battery_stats.percentage), battery_status_to_string(new_status));
                 std::ofstream log_file(config.LOG_BOOK_FILE_PATH, std::ios::app);
                 if (log_file.is_open()) {
                     log_file << line_stream.str();
@@ -65,6 +65,14 @@ public:
         return stop;
     }
 
+    // Swap the recognizer grammar, e.g. when the search vocabulary changes
+    void setGrammar(const std::string& _grammar_json) {
+        std::lock_guard<std::mutex> lock(cleanup_mutex);
+        grammar_json = _grammar_json;
+        if (rec)
+            vosk_recognizer_set_grm(rec, grammar_json.c_str());
+    }
+
 
 private:
     std::atomic<bool> stop;
@@ -207,7 +215,7 @@ private:
                             }
                             // float normalized_confidence = std::min(100.0f, confidence * 100.0f / 150.0f); // Example scaling
                             if (!text.empty() && confidence > 50.0f) {
-                                LOG_INFO("Recognized text: " + text + " Confidence: " + std::to_string(confidence));  
+                                LOG_INFOF("Recognized text: {} Confidence: {}", text, confidence);
                                 command_callback(text);
                             }
                         }
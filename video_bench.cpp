@@ -0,0 +1,105 @@
+// Plays training videos through Videocontroller without the UI and reports what the decode-ahead queue buys:
+// time from init() to the first frame, decode time per frame, queue occupancy, and stutters, both as timer ticks
+// that found the queue empty and as gaps between displayed frames longer than 1.5 frame intervals.
+// Takes .mp4 files or directories of them (the todo folder). Needs the audio sink the player uses.
+// g++ -std=c++17 -O2 -o video_bench video_bench.cpp $(pkg-config --cflags --libs opencv4 gstreamer-1.0) -ljsoncpp -lpthread
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+#include <cstdio>
+#include "videocontroller.h"
+
+struct FrameGaps {
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point last;
+    bool started = false;
+    double max_ms = 0.0;
+    size_t long_gaps = 0;
+    double limit_ms = 0.0;
+
+    void frame() {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (started) {
+            double gap = std::chrono::duration<double, std::milli>(now - last).count();
+            max_ms = std::max(max_ms, gap);
+            if (gap > limit_ms)
+                ++long_gaps;
+        }
+        started = true;
+        last = now;
+    }
+};
+
+static bool benchFile(const std::string& path, size_t decode_ahead, double seconds) {
+    Videocontroller video(path, decode_ahead);
+    FrameGaps gaps;
+    video.setFrameCallback([&gaps](cv::Mat) { gaps.frame(); });
+    {
+        // The controller falls back to 25 fps, so does the limit until the file says otherwise
+        cv::VideoCapture probe(path);
+        double fps = probe.isOpened() ? probe.get(cv::CAP_PROP_FPS) : 0.0;
+        gaps.limit_ms = 1.5 * 1000.0 / (fps > 0 ? fps : 25.0);
+    }
+    if (video.init() != 0) {
+        std::printf("%s: can't play\n", path.c_str());
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    while (!video.getStop() && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds)
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    Videocontroller::DecodeStats s = video.getStats();
+    video.stopPlaying();
+    video.releasevideo();
+
+    std::lock_guard<std::mutex> lock(gaps.mutex);
+    std::printf("%s\n  first frame %.1f ms, decode avg %.2f ms max %.2f ms, shown %zu/%zu decoded\n"
+                "  underruns %zu, frame gaps over %.0f ms %zu (longest %.0f ms), queue avg %.2f/%zu\n",
+                path.c_str(), s.first_frame_ms, s.avg_decode_ms, s.max_decode_ms, s.frames_shown, s.frames_decoded,
+                s.underruns, gaps.limit_ms, gaps.long_gaps, gaps.max_ms, s.avg_queue_depth, s.queue_capacity);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    size_t decode_ahead = 4;
+    double seconds = 20.0;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--ahead" && has_value) {
+            decode_ahead = std::stoul(argv[++i]);
+        } else if (arg == "--seconds" && has_value) {
+            seconds = std::stod(argv[++i]);
+        } else if (arg.rfind("--", 0) == 0) {
+            files.clear();
+            break;
+        } else if (std::filesystem::is_directory(arg)) {
+            std::vector<std::string> found;
+            for (const auto& entry : std::filesystem::directory_iterator(arg))
+                if (entry.is_regular_file() && entry.path().extension() == ".mp4")
+                    found.push_back(entry.path().string());
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty() || seconds <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [--ahead 4] [--seconds 20 per file] <video.mp4 | directory>..." << std::endl;
+        return 1;
+    }
+
+    std::printf("decode ahead %zu frames, up to %.0f s per file\n", decode_ahead, seconds);
+    int status = 0;
+    for (const auto& path : files)
+        if (!benchFile(path, decode_ahead, seconds))
+            status = 1;
+    Logger::flush();
+    return status;
+}
@@ -3,19 +3,42 @@
 
 #include <opencv2/opencv.hpp>
 #include <gst/gst.h>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
 #include "Logger.h"
 #include "Timer.h"
+#include "KeyframeIndex.h"
 
 class Videocontroller {
 public:
-    Videocontroller(const std::string& _video_path): video_path(_video_path), isStop(true), isPause(true), volume(35), pipeline(nullptr), volumeElement(nullptr) {
+    struct DecodeStats {
+        double first_frame_ms;    // init() start until the first frame was handed to the UI
+        double avg_decode_ms;     // average cap.read() time on the decode thread
+        double max_decode_ms;
+        size_t frames_decoded;
+        size_t frames_shown;
+        size_t underruns;         // timer ticks that found the queue empty (stutters)
+        size_t queue_depth;       // current occupancy
+        double avg_queue_depth;   // occupancy sampled at every tick
+        size_t queue_capacity;
+    };
+
+    Videocontroller(const std::string& _video_path, size_t _decode_ahead = 4): video_path(_video_path), isStop(true), isPause(true), volume(35), pipeline(nullptr), volumeElement(nullptr),
+        fps(25), decode_ahead(_decode_ahead > 0 ? _decode_ahead : 1) {
         LOG_INFO("Videocontroller Constructor");
+        resetStats();
     }
 
     ~Videocontroller(){
         LOG_INFO("Videocontroller Destructor");
         stopPlaying();
         releasevideo();
+        if (index_thread.joinable())
+            index_thread.join();
     }
 
     void update_video_path(const std::string& _video_path) {
@@ -25,6 +48,8 @@ public:
 
     int init() {
         try {
+            auto open_start = std::chrono::steady_clock::now();
+            resetStats();
             gst_init(nullptr, nullptr);
             // Open video with OpenCV
             cap.open(video_path);
@@ -34,12 +59,37 @@ public:
             }
 
             // Set frame rate for timer
-            double fps = cap.get(cv::CAP_PROP_FPS);
+            fps = cap.get(cv::CAP_PROP_FPS);
             if (fps <= 0) {
                 fps = 25; // Default if FPS retrieval fails
             }
-            int interval = static_cast<int>(1000 / fps);
-            timer.start(interval, 2, [this]() { PlayFrame(); });            
+            // Keyframe map for seeking, read from <video>.kfi or built on the first open; seeks use the plain
+            // position seek until it is ready
+            startIndexing();
+
+            // Decode the first frame right away so the view is not empty until the first timer tick
+            cv::Mat first;
+            auto decode_start = std::chrono::steady_clock::now();
+            if (!cap.read(first) || first.empty()) {
+                LOG_ERROR("Error: Could not decode the first video frame.");
+                cap.release();
+                return -1;
+            }
+            recordDecode(decode_start);
+            shown_ms = cap.get(cv::CAP_PROP_POS_MSEC);
+            if (Frame_callback) {
+                Frame_callback(first);
+            }
+            double first_frame_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - open_start).count();
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                stats.frames_shown++;
+                stats.first_frame_ms = first_frame_ms;
+            }
+            LOG_INFO("Video first frame after " + std::to_string(first_frame_ms) + " ms");
+
+            startDecoder();
+            timer.start(frameInterval(), [this]() { PlayFrame(); }, CatchUp::Burst);            
             isStop = false;
             isPause = false;
             
@@ -51,7 +101,11 @@ public:
             pipeline = gst_parse_launch(audioPipelineDesc.c_str(), nullptr);
             if (!pipeline) {
                 LOG_ERROR("Failed to create GStreamer audio pipeline.");
+                timer.stop();
+                stopDecoder();
                 cap.release();
+                isStop = true;
+                isPause = true;
                 return -1;
             }
             volumeElement = gst_bin_get_by_name(GST_BIN(pipeline), "vol");        
@@ -68,7 +122,8 @@ public:
         if (!pipeline || !cap.isOpened())
             return;
         gst_element_set_state(pipeline, GST_STATE_PLAYING);
-        timer.start(static_cast<int>(1000 / cap.get(cv::CAP_PROP_FPS)), 1, [this]() { PlayFrame(); });
+        startDecoder();
+        timer.start(frameInterval(), [this]() { PlayFrame(); }, CatchUp::Burst);
         isStop = false;
         isPause = false;
     }
@@ -82,13 +137,22 @@ public:
             return;
         gst_element_set_state(pipeline, GST_STATE_NULL);
         timer.stop();
-        cap.set(cv::CAP_PROP_POS_FRAMES, 0);
+        stopDecoder();
+        {
+            std::lock_guard<std::mutex> cap_lock(cap_mutex);
+            cap.set(cv::CAP_PROP_POS_FRAMES, 0);
+            dropQueue();
+        }
+        shown_ms = 0.0;
+        logStats();
         isStop = true;
         isPause = true;
     }
 
     void releasevideo() {
         timer.stop();
+        stopDecoder();
+        dropQueue();
         isStop = true;
         isPause = true;
         if (cap.isOpened())
@@ -112,7 +176,7 @@ public:
             timer.stop();
         } else {
             gst_element_set_state(pipeline, GST_STATE_PLAYING);
-            timer.start(static_cast<int>(1000 / cap.get(cv::CAP_PROP_FPS)), 1, [this]() { PlayFrame(); });
+            timer.start(frameInterval(), [this]() { PlayFrame(); }, CatchUp::Burst);
         }
         isPause = !isPause;
     }
@@ -120,27 +184,31 @@ public:
     void seekForward(int _value) {
         if (!pipeline || !cap.isOpened())
             return;
-        pauseTimer();
-        double pos = cap.get(cv::CAP_PROP_POS_MSEC);
-        double new_pos = pos + _value;
-        cap.set(cv::CAP_PROP_POS_MSEC, new_pos);
-        gst_element_seek_simple(pipeline, GST_FORMAT_TIME,
-                                GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT),
-                                static_cast<gint64>(new_pos * GST_MSECOND));
-        resumeTimer();
+        seekTo(seekBase() + _value);
     }
     
     void seekBackward(int _value) {
         if (!pipeline || !cap.isOpened())
             return;
-        pauseTimer();
-        double pos = cap.get(cv::CAP_PROP_POS_MSEC);
-        double new_pos = std::max(pos - _value, 0.0);
-        cap.set(cv::CAP_PROP_POS_MSEC, new_pos);
-        gst_element_seek_simple(pipeline, GST_FORMAT_TIME,
-                                GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT),
-                                static_cast<gint64>(new_pos * GST_MSECOND));
-        resumeTimer();
+        seekTo(std::max(seekBase() - _value, 0.0));
+    }
+
+    // Hands the seek to the decode thread and returns; a newer seek replaces one that hasn't started yet.
+    // The decoder lands on the frame shown at target_ms (see performSeek), shows it and aligns the audio.
+    void seekTo(double target_ms) {
+        if (!pipeline || !cap.isOpened())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            seek_target_ms = target_ms;
+            seek_pending = true;
+            seek_requested = std::chrono::steady_clock::now();
+            frame_queue.clear();
+            queue_generation++;    // the frame being decoded now belongs to the old position
+            decode_eof = false;
+        }
+        queue_cv.notify_all();
+        startDecoder();   // no-op while playing; a seek after stop decodes from the new position
     }
     
     void volumeChanged(int _volume){
@@ -156,7 +224,7 @@ public:
 
     void resumeTimer() {
         if (!isStop && !isPause) { // Only restart if playback isn’t stopped or paused
-            timer.start(static_cast<int>(1000 / cap.get(cv::CAP_PROP_FPS)), 1, [this]() { PlayFrame(); });
+            timer.start(frameInterval(), [this]() { PlayFrame(); }, CatchUp::Burst);
         }
     }
     bool getStop() {
@@ -172,6 +240,16 @@ public:
         return volume;
     }
 
+    DecodeStats getStats() {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        DecodeStats s = stats;
+        s.queue_depth = frame_queue.size();
+        s.queue_capacity = decode_ahead;
+        s.avg_decode_ms = stats.frames_decoded ? decode_ms_total / stats.frames_decoded : 0.0;
+        s.avg_queue_depth = depth_samples ? static_cast<double>(depth_total) / depth_samples : 0.0;
+        return s;
+    }
+
 private:
     std::string video_path;
     bool isStop;
@@ -179,23 +257,243 @@ private:
     int volume;
     GstElement *pipeline;
     GstElement *volumeElement;
-    Timer timer;
-    int fps;
+    Timer timer{"media", "playback"};
+    double fps;
     cv::VideoCapture cap;    
     cv::Mat frame;
     std::function<void(cv::Mat)> Frame_callback;
+    KeyframeIndex keyframes;               // written by index_thread only while index_ready is false
+    std::thread index_thread;
+    std::atomic<bool> index_ready{false};
+    std::atomic<double> shown_ms{0.0};     // timestamp of the frame on screen, seeks are relative to it
 
-    void PlayFrame() {
-        if (cap.isOpened()) {
-            cv::Mat frame;
-            if (cap.read(frame) && !frame.empty()) {
-                if (Frame_callback) {
-                    Frame_callback(frame);
+    // Decode-ahead queue, filled by decode_thread and drained by PlayFrame
+    size_t decode_ahead;
+    std::thread decode_thread;
+    std::atomic<bool> decode_running{false};
+    std::mutex cap_mutex;                  // guards cap between the decoder and seeks
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<std::pair<double, cv::Mat>> frame_queue;   // (timestamp ms, frame)
+    uint64_t queue_generation = 0;         // bumped on every drop so in-flight frames are discarded
+    bool decode_eof = false;
+    bool seek_pending = false;             // seek_target_ms waits for the decode thread
+    bool seek_running = false;             // the decode thread is landing a seek, the queue is empty on purpose
+    double seek_target_ms = 0.0;
+    std::chrono::steady_clock::time_point seek_requested;
+    DecodeStats stats;
+    double decode_ms_total = 0.0;
+    size_t depth_total = 0;
+    size_t depth_samples = 0;
+
+    int frameInterval() const {
+        return static_cast<int>(1000 / fps);
+    }
+
+    void startIndexing() {
+        if (index_thread.joinable())
+            index_thread.join();
+        index_ready = false;
+        index_thread = std::thread([this, path = video_path]() {
+            keyframes.loadOrBuild(path);
+            index_ready = true;
+        });
+    }
+
+    void startDecoder() {
+        if (decode_running)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            decode_eof = false;
+        }
+        decode_running = true;
+        decode_thread = std::thread([this]() { DecodeLoop(); });
+    }
+
+    void stopDecoder() {
+        decode_running = false;
+        queue_cv.notify_all();
+        if (decode_thread.joinable()) {
+            decode_thread.join();
+        }
+    }
+
+    // Callers that move the read position must hold cap_mutex so no stale frame slips in
+    void dropQueue() {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        frame_queue.clear();
+        queue_generation++;
+        decode_eof = false;
+        seek_pending = false;
+        queue_cv.notify_all();
+    }
+
+    // Relative seeks count from a seek still in flight, so repeated presses add up
+    double seekBase() {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        return seek_pending || seek_running ? seek_target_ms : shown_ms.load();
+    }
+
+    // Runs on the decode thread. Jumps to the nearest keyframe at or before the target (a plain time seek without
+    // the index) and grabs forward until CAP_PROP_POS_MSEC reaches the target. The landed position is checked
+    // against the decoder's own timestamps, so an index that disagrees with the demuxer (edit lists, reordered
+    // B-frames) costs one extra time seek instead of showing the wrong frame.
+    void performSeek() {
+        std::lock_guard<std::mutex> cap_lock(cap_mutex);
+        double target_ms;
+        std::chrono::steady_clock::time_point requested;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            target_ms = seek_target_ms;
+            requested = seek_requested;
+            seek_pending = false;
+            seek_running = true;
+        }
+        double half_frame = 500.0 / fps;
+        bool indexed = index_ready && !keyframes.empty();
+        double start_ms = target_ms;
+        if (indexed) {
+            if (keyframes.durationMs() > 0)
+                target_ms = std::min(target_ms, std::max(keyframes.durationMs() - 1000.0 / fps, 0.0));
+            start_ms = keyframes.lookup(target_ms).time_ms;
+        }
+        cap.set(cv::CAP_PROP_POS_MSEC, start_ms);
+        // Frames between the keyframe and the target, with room for variable frame rates
+        int64_t budget = static_cast<int64_t>((target_ms - start_ms) * fps / 1000.0) * 2 + 16;
+        bool corrected = !indexed;
+        double landed_ms = -1.0;
+        for (int64_t grabbed = 0; grabbed < budget && cap.grab(); ++grabbed) {  // grab() skips the colour conversion
+            landed_ms = cap.get(cv::CAP_PROP_POS_MSEC);
+            if (landed_ms + half_frame < target_ms)
+                continue;
+            if (grabbed == 0 && !corrected && landed_ms > target_ms + half_frame) {
+                LOG_WARN("Video seek: keyframe index is off (landed at " + std::to_string(landed_ms) + " ms for " +
+                         std::to_string(target_ms) + " ms), seeking by time");
+                cap.set(cv::CAP_PROP_POS_MSEC, target_ms);
+                corrected = true;
+                grabbed = -1;
+                continue;
+            }
+            break;
+        }
+        cv::Mat landed;
+        if (landed_ms < 0 || !cap.retrieve(landed) || landed.empty()) {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            seek_running = false;
+            LOG_WARN("Video seek to " + std::to_string(target_ms) + " ms found no frame");
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            seek_running = false;
+            if (seek_pending)
+                return;   // superseded while we decoded, the next seek starts right away
+            shown_ms = landed_ms;
+            stats.frames_shown++;
+        }
+        gst_element_seek_simple(pipeline, GST_FORMAT_TIME,
+                                GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE),
+                                static_cast<gint64>(landed_ms * GST_MSECOND));
+        if (Frame_callback) {
+            Frame_callback(landed);
+        }
+        LOG_INFO("Video seek to " + std::to_string(landed_ms) + " ms took " +
+                 std::to_string(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - requested).count()) + " ms");
+    }
+
+    void DecodeLoop() {
+        try {
+            while (decode_running) {
+                {
+                    std::unique_lock<std::mutex> lock(queue_mutex);
+                    queue_cv.wait(lock, [this]() {
+                        return !decode_running || seek_pending || (!decode_eof && frame_queue.size() < decode_ahead);
+                    });
+                    if (!decode_running)
+                        break;
+                    if (seek_pending) {
+                        lock.unlock();
+                        performSeek();
+                        continue;
+                    }
+                }
+                // Seeks move the position under cap_mutex, so the generation read here matches the frame we decode
+                std::lock_guard<std::mutex> cap_lock(cap_mutex);
+                uint64_t generation;
+                {
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    if (seek_pending)
+                        continue; // posted after the wait, don't decode one more frame at the old position
+                    generation = queue_generation;
                 }
-            } else {
-                stopPlaying(); // End of video
+                cv::Mat decoded;
+                auto decode_start = std::chrono::steady_clock::now();
+                bool ok = cap.isOpened() && cap.read(decoded) && !decoded.empty();
+                double decoded_ms = ok ? cap.get(cv::CAP_PROP_POS_MSEC) : 0.0;
+                if (ok)
+                    recordDecode(decode_start);
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                if (generation != queue_generation)
+                    continue; // the queue was dropped while we were decoding
+                if (ok)
+                    frame_queue.emplace_back(decoded_ms, decoded);
+                else
+                    decode_eof = true;
             }
+        } catch (const std::exception& e) {
+            LOG_ERROR("Videocontroller decode error: " + std::string(e.what()));
+        }
+    }
+
+    void recordDecode(std::chrono::steady_clock::time_point decode_start) {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decode_start).count();
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        decode_ms_total += ms;
+        stats.max_decode_ms = std::max(stats.max_decode_ms, ms);
+        stats.frames_decoded++;
+    }
+
+    void resetStats() {
+        stats = DecodeStats{0.0, 0.0, 0.0, 0, 0, 0, 0, 0.0, decode_ahead};
+        decode_ms_total = 0.0;
+        depth_total = 0;
+        depth_samples = 0;
+    }
+
+    void logStats() {
+        DecodeStats s = getStats();
+        LOG_INFO("Video stats: first frame " + std::to_string(s.first_frame_ms) + " ms, decode avg " + std::to_string(s.avg_decode_ms) +
+                 " ms max " + std::to_string(s.max_decode_ms) + " ms, shown " + std::to_string(s.frames_shown) + "/" + std::to_string(s.frames_decoded) +
+                 ", underruns " + std::to_string(s.underruns) + ", avg queue " + std::to_string(s.avg_queue_depth) + "/" + std::to_string(s.queue_capacity));
+    }
+
+    void PlayFrame() {
+        cv::Mat next;
+        bool end_of_video = false;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            depth_total += frame_queue.size();
+            depth_samples++;
+            if (!frame_queue.empty()) {
+                shown_ms = frame_queue.front().first;
+                next = frame_queue.front().second;
+                frame_queue.pop_front();
+                stats.frames_shown++;
+                queue_cv.notify_one();
+            } else if (decode_eof) {
+                end_of_video = true;
+            } else if (!seek_pending && !seek_running) {
+                stats.underruns++; // decoder fell behind, this tick repeats the previous frame
+            }
+        }
+        if (end_of_video) {
+            stopPlaying(); // End of video
+            return;
+        }
+        if (!next.empty() && Frame_callback) {
+            Frame_callback(next);
         }
     }
 };
-#endif // VIDEOCONTROLLER_H
\ No newline at end of file
+#endif // VIDEOCONTROLLER_H
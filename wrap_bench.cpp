@@ -0,0 +1,158 @@
+// Microbenchmark for PDFCreator::addText line breaking over long Cyrillic, Arabic and Latin strings: the one-pass
+// breaker (first add of a string, then the memoized repeat) against the prefix-measuring loop addText used before,
+// which called HPDF_Page_TextWidth for every prefix of the remaining text. Line counts of both are compared.
+// g++ -std=c++17 -O2 -fPIC -o wrap_bench wrap_bench.cpp $(pkg-config --cflags --libs Qt5Gui) -lhpdf -lpng -lz -ljsoncpp -lpthread
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include "PDFCreator.h"
+
+static const char* FONT_PATH = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";   // the font PDFCreator loads
+
+struct Sample {
+    const char* name;
+    std::vector<std::string> words;
+};
+
+static const Sample SAMPLES[] = {
+    {"cyrillic", {"Проверьте", "давление", "в", "гидравлической", "системе", "перед", "запуском", "насоса,", "затем",
+                  "затяните", "крепёжные", "болты", "фланца", "моментом", "45", "Н·м"}},
+    {"arabic", {"تحقق", "من", "الضغط", "في", "النظام", "الهيدروليكي", "قبل", "تشغيل", "المضخة،", "ثم", "أحكم", "ربط",
+                "مسامير", "الشفة", "بعزم", "45", "نيوتن·متر"}},
+    {"latin", {"Check", "the", "pressure", "in", "the", "hydraulic", "system", "before", "starting", "the", "pump,",
+               "then", "tighten", "the", "flange", "bolts", "to", "45", "Nm"}},
+};
+
+static std::string buildText(const Sample& sample, size_t codepoints, size_t variant) {
+    std::string text = std::to_string(variant);
+    size_t count = 0, word = 0;
+    while (count < codepoints) {
+        const std::string& next = sample.words[word++ % sample.words.size()];
+        text += ' ';
+        text += next;
+        for (unsigned char c : next)
+            if ((c & 0xC0) != 0x80)
+                ++count;
+    }
+    return text;
+}
+
+static size_t nextCodepointEnd(const std::string& text, size_t pos) {
+    ++pos;
+    while (pos < text.size() && (static_cast<unsigned char>(text[pos]) & 0xC0) == 0x80)
+        ++pos;
+    return pos;
+}
+
+// The breaker addText used before, stepping by whole codepoints so its lines can be compared
+static size_t prefixWrap(HPDF_Page page, const std::string& text, float maxLineWidth) {
+    size_t lines = 0;
+    std::string remaining = text;
+    while (!remaining.empty()) {
+        size_t fit = remaining.size();
+        size_t lastSpace = std::string::npos;
+        for (size_t end = nextCodepointEnd(remaining, 0); ; end = nextCodepointEnd(remaining, end)) {
+            std::string prefix = remaining.substr(0, end);
+            if (HPDF_Page_TextWidth(page, prefix.c_str()) > maxLineWidth) {
+                size_t charStart = end;
+                while (charStart > 0 && (static_cast<unsigned char>(remaining[charStart - 1]) & 0xC0) == 0x80)
+                    --charStart;
+                --charStart;
+                fit = lastSpace != std::string::npos ? lastSpace : std::max<size_t>(charStart, nextCodepointEnd(remaining, 0));
+                break;
+            }
+            if (remaining[end - 1] == ' ')
+                lastSpace = end - 1;
+            if (end >= remaining.size())
+                break;
+        }
+        ++lines;
+        remaining = remaining.substr(fit);
+        size_t skip = 0;
+        while (skip < remaining.size() && remaining[skip] == ' ')
+            ++skip;
+        remaining.erase(0, skip);
+    }
+    return lines;
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t length = 2000;
+    size_t strings = 50;
+    size_t repeats = 20;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--length" && has_value) {
+            length = std::stoul(argv[++i]);
+        } else if (arg == "--strings" && has_value) {
+            strings = std::stoul(argv[++i]);
+        } else if (arg == "--repeats" && has_value) {
+            repeats = std::stoul(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--length 2000 codepoints] [--strings 50] [--repeats 20]" << std::endl;
+            return 1;
+        }
+    }
+    if (length == 0 || strings == 0) {
+        std::cerr << "--length and --strings must be positive" << std::endl;
+        return 1;
+    }
+
+    int status = 0;
+    try {
+        // Same page, font and size as PDFCreator for the reference breaker
+        HPDF_Doc reference = HPDF_New(PDFCreator::error_handler, nullptr);
+        HPDF_UseUTFEncodings(reference);
+        HPDF_SetCurrentEncoder(reference, "UTF-8");
+        HPDF_Font font = HPDF_GetFont(reference, HPDF_LoadTTFontFromFile(reference, FONT_PATH, HPDF_TRUE), "UTF-8");
+        HPDF_Page page = HPDF_AddPage(reference);
+        HPDF_Page_SetSize(page, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
+        HPDF_Page_SetFontAndSize(page, font, 15);
+        const float maxLineWidth = HPDF_Page_GetWidth(page) - 100 - 50;   // as in addText
+
+        std::printf("%zu strings of %zu codepoints, %zu memoized repeats each\n", strings, length, repeats);
+        for (const Sample& sample : SAMPLES) {
+            std::vector<std::string> texts;
+            for (size_t v = 0; v < strings; ++v)
+                texts.push_back(buildText(sample, length, v));
+
+            auto start = std::chrono::steady_clock::now();
+            size_t reference_lines = 0;
+            for (const std::string& text : texts)
+                reference_lines += prefixWrap(page, text, maxLineWidth);
+            double reference_ms = msSince(start);
+
+            PDFCreator pdf;
+            start = std::chrono::steady_clock::now();
+            for (const std::string& text : texts)
+                pdf.addText(text);
+            double first_ms = msSince(start);
+            size_t lines = static_cast<size_t>(pdf.getLineCount());
+
+            start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < repeats; ++r)
+                for (const std::string& text : texts)
+                    pdf.addText(text);
+            double repeat_ms = repeats ? msSince(start) / repeats : 0.0;
+
+            std::printf("%-8s prefix %9.3f ms/string  one-pass %7.3f ms/string  memoized %7.3f ms/string (incl. output)  lines %zu/%zu%s\n",
+                        sample.name, reference_ms / strings, first_ms / strings, repeat_ms / strings, lines, reference_lines,
+                        lines == reference_lines ? "" : "  MISMATCH");
+            if (lines != reference_lines)
+                status = 1;
+        }
+        HPDF_Free(reference);
+    } catch (const std::exception& e) {
+        std::cerr << "wrap_bench: " << e.what() << std::endl;
+        status = 1;
+    }
+    Logger::flush();
+    return status;
+}